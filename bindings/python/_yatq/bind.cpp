@@ -2,6 +2,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/chrono.h>
 #include <pybind11/functional.h>
+#include <pybind11/stl.h>
 
 #include <functional>
 
@@ -13,6 +14,9 @@
 
 #include "yatq/thread_pool.h"
 #include "yatq/timer_queue.h"
+#ifndef YATQ_DISABLE_FUTURES
+#include "yatq/utils/boost_future_utils.h"
+#endif
 #include "yatq/version.h"
 
 #include "traits.h"
@@ -27,6 +31,15 @@ using Executable = std::function<result_type(void)>;
 using ThreadPool = yatq::ThreadPool<Executable>;
 using TimerQueue = yatq::TimerQueue<ThreadPool>;
 
+// NB: python API keeps 'boost::future' for job results (see 'pytq.pythonize()')
+typedef struct {
+    TimerQueue::uid_t uid;
+    TimerQueue::Clock::time_point deadline;
+#ifndef YATQ_DISABLE_FUTURES
+    Future result;
+#endif
+} TimerHandle;
+
 PYBIND11_MODULE(_yatq, m) {
 #ifndef YATQ_DISABLE_FUTURES
     auto boost_submodule = m.def_submodule("boost");
@@ -70,19 +83,131 @@ PYBIND11_MODULE(_yatq, m) {
         .value("min_priority", yatq::utils::min_priority)
         .value("max_priority", yatq::utils::max_priority)
         .export_values();
+
+    py::class_<yatq::utils::ThreadGroup>(utils_submodule, "ThreadGroup")
+        .def(
+            py::init(
+                [] (std::size_t num_threads, std::vector<int> cpus, int numa_node) {
+                    return yatq::utils::ThreadGroup {num_threads, std::move(cpus), numa_node};
+                }
+            ),
+            py::arg("num_threads"),
+            py::arg("cpus") = std::vector<int>(),
+            py::arg("numa_node") = -1
+        )
+        .def_readwrite("num_threads", &yatq::utils::ThreadGroup::num_threads)
+        .def_readwrite("cpus", &yatq::utils::ThreadGroup::cpus)
+        .def_readwrite("numa_node", &yatq::utils::ThreadGroup::numa_node);
 #endif
 
+    py::enum_<yatq::overflow_policy_t>(m, "overflow_policy_t")
+        .value("block_when_full", yatq::block_when_full)
+        .value("reject_when_full", yatq::reject_when_full)
+        .value("drop_oldest_when_full", yatq::drop_oldest_when_full)
+        .export_values();
+
+    py::enum_<yatq::submit_status_t>(m, "submit_status_t")
+        .value("submit_accepted", yatq::submit_accepted)
+        .value("submit_rejected", yatq::submit_rejected)
+        .export_values();
+
+    py::class_<yatq::OverflowStats>(m, "OverflowStats")
+        .def_readonly("rejected", &yatq::OverflowStats::rejected)
+        .def_readonly("blocked", &yatq::OverflowStats::blocked)
+        .def_readonly("dropped", &yatq::OverflowStats::dropped);
+
+    py::class_<yatq::utils::HistogramSummary>(m, "HistogramSummary")
+        .def_readonly("count", &yatq::utils::HistogramSummary::count)
+        .def_readonly("min", &yatq::utils::HistogramSummary::min)
+        .def_readonly("max", &yatq::utils::HistogramSummary::max)
+        .def_readonly("mean", &yatq::utils::HistogramSummary::mean)
+        .def_readonly("p50", &yatq::utils::HistogramSummary::p50)
+        .def_readonly("p90", &yatq::utils::HistogramSummary::p90)
+        .def_readonly("p99", &yatq::utils::HistogramSummary::p99)
+        .def_readonly("p999", &yatq::utils::HistogramSummary::p999);
+
+    py::class_<yatq::WorkerStats>(m, "WorkerStats")
+        .def_readonly("jobs", &yatq::WorkerStats::jobs)
+        .def_readonly("busy_time", &yatq::WorkerStats::busy_time)
+        .def_readonly("idle_time", &yatq::WorkerStats::idle_time);
+
+    py::class_<yatq::ThreadPoolStats>(m, "ThreadPoolStats")
+        .def_readonly("queue_depth", &yatq::ThreadPoolStats::queue_depth)
+        .def_readonly("oldest_job_age", &yatq::ThreadPoolStats::oldest_job_age)
+        .def_readonly("wait_time", &yatq::ThreadPoolStats::wait_time)
+        .def_readonly("service_time", &yatq::ThreadPoolStats::service_time)
+        .def_readonly("workers", &yatq::ThreadPoolStats::workers);
+
     py::class_<ThreadPool>(m, "ThreadPool")
         .def(py::init<>())
-        .def("start", &ThreadPool::start, py::arg("num_threads"))
+        .def("start", py::overload_cast<std::size_t>(&ThreadPool::start), py::arg("num_threads"))
+#ifndef YATQ_DISABLE_PTHREAD
+        .def("start", py::overload_cast<std::size_t, int, yatq::utils::priority_t>(&ThreadPool::start), py::arg("num_threads"), py::arg("sched_policy"), py::arg("priority") = yatq::utils::max_priority)
+        .def("start", py::overload_cast<std::size_t, int, int>(&ThreadPool::start), py::arg("num_threads"), py::arg("sched_policy"), py::arg("priority"))
+        .def("start", py::overload_cast<const std::vector<yatq::utils::ThreadGroup>&>(&ThreadPool::start), py::arg("groups"))
+        .def("start", py::overload_cast<const std::vector<yatq::utils::ThreadGroup>&, int, yatq::utils::priority_t>(&ThreadPool::start), py::arg("groups"), py::arg("sched_policy"), py::arg("priority") = yatq::utils::max_priority)
+        .def("start", py::overload_cast<const std::vector<yatq::utils::ThreadGroup>&, int, int>(&ThreadPool::start), py::arg("groups"), py::arg("sched_policy"), py::arg("priority"))
+#endif
         .def("stop", &ThreadPool::stop)
-        .def("execute", &ThreadPool::execute, py::arg("job"));
+        .def(
+            "execute",
+            [] (ThreadPool& _this, Executable job) {
+#ifndef YATQ_DISABLE_FUTURES
+                return yatq::utils::to_boost_future(_this.execute(std::move(job)));
+#else
+                _this.execute(std::move(job));
+#endif
+            },
+            py::arg("job")
+        )
+        .def("execute_detached", &ThreadPool::execute_detached, py::arg("job"))
+        .def(
+            "try_execute",
+            [] (ThreadPool& _this, Executable job) {
+#ifndef YATQ_DISABLE_FUTURES
+                auto future = _this.try_execute(std::move(job));
+                return future ? std::optional<Future>(yatq::utils::to_boost_future(std::move(*future))) : std::nullopt;
+#else
+                return _this.try_execute(std::move(job));
+#endif
+            },
+            py::arg("job")
+        )
+        .def("try_execute_detached", &ThreadPool::try_execute_detached, py::arg("job"))
+        .def("set_capacity", &ThreadPool::set_capacity, py::arg("capacity"))
+        .def("set_overflow_policy", &ThreadPool::set_overflow_policy, py::arg("policy"))
+        .def("overflow_stats", &ThreadPool::overflow_stats)
+        .def("set_stats_enabled", &ThreadPool::set_stats_enabled, py::arg("enabled"))
+        .def("stats", &ThreadPool::stats, py::call_guard<py::gil_scoped_release>());
+
+    py::enum_<yatq::admission_policy_t>(m, "admission_policy_t")
+        .value("fail_when_full", yatq::fail_when_full)
+        .value("evict_when_full", yatq::evict_when_full)
+        .export_values();
 
-    py::class_<TimerQueue::TimerHandle>(m, "TimerHandle")
-        .def_readwrite("uid", &TimerQueue::TimerHandle::uid)
-        .def_readwrite("deadline", &TimerQueue::TimerHandle::deadline)
+    py::class_<yatq::ShedStats>(m, "ShedStats")
+        .def_readonly("rejected", &yatq::ShedStats::rejected)
+        .def_readonly("evicted", &yatq::ShedStats::evicted)
+        .def_readonly("late", &yatq::ShedStats::late);
+
+    py::class_<yatq::TimerQueueStats>(m, "TimerQueueStats")
+        .def_readonly("enqueued", &yatq::TimerQueueStats::enqueued)
+        .def_readonly("fired", &yatq::TimerQueueStats::fired)
+        .def_readonly("canceled", &yatq::TimerQueueStats::canceled)
+        .def_readonly("tombstones", &yatq::TimerQueueStats::tombstones)
+        .def_readonly("live_timers", &yatq::TimerQueueStats::live_timers)
+        .def_readonly("heap_size", &yatq::TimerQueueStats::heap_size)
+        .def_readonly("heap_capacity", &yatq::TimerQueueStats::heap_capacity)
+        .def_readonly("timeout_wakeups", &yatq::TimerQueueStats::timeout_wakeups)
+        .def_readonly("notified_wakeups", &yatq::TimerQueueStats::notified_wakeups)
+        .def_readonly("spurious_wakeups", &yatq::TimerQueueStats::spurious_wakeups)
+        .def_readonly("lateness", &yatq::TimerQueueStats::lateness);
+
+    py::class_<TimerHandle>(m, "TimerHandle")
+        .def_readwrite("uid", &TimerHandle::uid)
+        .def_readwrite("deadline", &TimerHandle::deadline)
 #ifndef YATQ_DISABLE_FUTURES
-        .def_readonly("result", &TimerQueue::TimerHandle::result)
+        .def_readonly("result", &TimerHandle::result)
 #endif
         ;
 
@@ -94,10 +219,70 @@ PYBIND11_MODULE(_yatq, m) {
         .def("start", py::overload_cast<int, int>(&TimerQueue::start), py::arg("sched_policy"), py::arg("priority"))
 #endif
         .def("stop", &TimerQueue::stop)
-        .def("enqueue", &TimerQueue::enqueue, py::arg("deadline"), py::arg("job"))
+        .def(
+            "enqueue",
+            [] (TimerQueue& _this, const TimerQueue::Clock::time_point& deadline, Executable job, int priority) {
+                auto handle = _this.enqueue(deadline, std::move(job), {.priority = priority});
+                return TimerHandle {
+                    handle.uid
+                    , handle.deadline
+#ifndef YATQ_DISABLE_FUTURES
+                    , yatq::utils::to_boost_future(std::move(handle.result))
+#endif
+                };
+            },
+            py::arg("deadline"),
+            py::arg("job"),
+            py::arg("priority") = 0
+        )
+#ifndef YATQ_DISABLE_FUTURES
+        .def(
+            "enqueue",
+            [] (TimerQueue& _this, const TimerQueue::Clock::time_point& deadline, Executable job, std::function<void(Future)> on_complete) {
+                return _this.enqueue(
+                    deadline,
+                    std::move(job),
+                    [on_complete = std::move(on_complete)]
+                    (TimerQueue::Future future)
+                    { on_complete(yatq::utils::to_boost_future(std::move(future))); }
+                );
+            },
+            py::arg("deadline"),
+            py::arg("job"),
+            py::arg("on_complete")
+        )
+#endif
+        .def(
+            "enqueue_detached",
+            py::overload_cast<const TimerQueue::Clock::time_point&, Executable>(&TimerQueue::enqueue_detached),
+            py::arg("deadline"),
+            py::arg("job")
+        )
         .def("cancel", &TimerQueue::cancel, py::arg("uid"))
         .def("clear", &TimerQueue::clear)
         .def("purge", &TimerQueue::purge)
+        .def("set_auto_purge", &TimerQueue::set_auto_purge, py::arg("ratio"), py::arg("slice") = 1024)
+        .def("set_capacity", &TimerQueue::set_capacity, py::arg("capacity"), py::arg("policy") = yatq::fail_when_full)
+        .def(
+            "set_max_lateness",
+            [] (
+                TimerQueue& _this,
+                const TimerQueue::Clock::duration& max_lateness,
+                int max_priority,
+                std::optional<std::function<void(TimerQueue::uid_t, const TimerQueue::Clock::time_point&)>> on_late
+            ) {
+                TimerQueue::LateCallback callback;
+                if (on_late) {
+                    callback = TimerQueue::LateCallback(std::move(*on_late));
+                }
+                _this.set_max_lateness(max_lateness, max_priority, std::move(callback));
+            },
+            py::arg("max_lateness"),
+            py::arg("max_priority") = 0,
+            py::arg("on_late") = py::none()
+        )
+        .def("shed_stats", &TimerQueue::shed_stats)
+        .def("stats", &TimerQueue::stats)
         .def("in_queue", &TimerQueue::in_queue, py::arg("uid"));
 
     m.attr("__version__") = YATQ_VERSION;
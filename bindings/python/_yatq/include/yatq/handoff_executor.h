@@ -0,0 +1,271 @@
+#ifndef _YATQ_HANDOFF_EXECUTOR_H
+#define _YATQ_HANDOFF_EXECUTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "yatq/internal/concepts.h"
+#include "yatq/internal/log4cxx_proxy.h"
+#include "yatq/utils/logging_utils.h"
+#ifndef YATQ_DISABLE_FUTURES
+#include "yatq/completion.h"
+#endif
+#include "yatq/move_only_function.h"
+
+namespace yatq {
+
+using internal::ExecutableGeneric;
+
+/**
+ * executor for a single producer, typically the timer queue thread. each worker thread owns a single-producer
+ * single-consumer ring; the producer puts a job into the least loaded ring and wakes its worker (\a std::atomic::wait,
+ * i.e. a futex) only if the worker is parked. no lock is taken on the way from \a execute() to the job start.
+ * \a execute() must not be called from more than one thread at a time
+ * @tparam Capacity ring size per worker; power of 2
+ */
+template<ExecutableGeneric _Executable = MoveOnlyFunction<void(void)>, std::size_t Capacity = 1024>
+class HandoffExecutor {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+    using Executable = _Executable;
+    using result_type = internal::executable_result_t<Executable>;
+#ifndef YATQ_DISABLE_FUTURES
+    using Future = CompletionHandle<result_type>;
+    using Slot = CompletionSlot<result_type>;
+#endif
+
+private:
+    static constexpr std::size_t cache_line = 64;
+    static constexpr int spin_count = 256;
+
+    typedef struct {
+        Executable job;
+#ifndef YATQ_DISABLE_FUTURES
+        Slot slot;
+#endif
+    } QueueEntry;
+
+    static constexpr std::uint32_t RUNNING = 0;
+    static constexpr std::uint32_t PARKED = 1;
+
+    struct Worker {
+        std::unique_ptr<QueueEntry[]> ring;
+        alignas(cache_line) std::atomic<std::size_t> head;  // NB: written by the worker
+        alignas(cache_line) std::atomic<std::size_t> tail;  // NB: written by the producer
+        alignas(cache_line) std::atomic<std::uint32_t> state;
+        std::thread thread;
+
+        Worker(): ring(new QueueEntry[Capacity]), head(0), tail(0), state(RUNNING) {}
+    };
+
+    std::atomic<bool> _running;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::size_t _next_worker;  // NB: producer only
+#ifndef YATQ_DISABLE_FUTURES
+    CompletionPool<result_type> _completions;
+#endif
+
+public:
+    /**
+     * create executor
+     */
+    HandoffExecutor(): _running(false), _next_worker(0) {}
+
+    /**
+     * start worker threads. rings and the jobs left in them survive \a stop() => a restart starts as many threads as
+     * the largest previous start at least, and \a num_threads only adds threads beyond that
+     * @param num_threads number of threads
+     */
+    void start(std::size_t num_threads) {
+        if (!_running) {
+            _running = true;
+            while (_workers.size() < num_threads) {  // NB: rings survive restart
+                _workers.push_back(std::make_unique<Worker>());
+            }
+            for (std::size_t i = 0; i < _workers.size(); ++i) {
+                std::string thread_tag = std::format("handoff thread #{}", i);
+                _workers[i]->thread = std::thread(&HandoffExecutor::thread_routine, this, i, std::move(thread_tag));
+            }
+        }
+    }
+
+    /**
+     * stop and join all the threads
+     */
+    void stop() {
+        if (_running) {
+            _running = false;
+            for (auto&& worker: _workers) {
+                wake(*worker);
+                if (worker->thread.joinable()) {
+                    worker->thread.join();
+                }
+            }
+        }
+    }
+
+    /**
+     * execute job in a thread
+     * @param job job to execute
+     * @return future object. use it to obtain job result
+     */
+#ifndef YATQ_DISABLE_FUTURES
+    Future
+#else
+    void
+#endif
+    execute(Executable job) {
+#ifndef YATQ_DISABLE_FUTURES
+        auto [slot, future] = _completions.make();
+        push({std::move(job), std::move(slot)});
+        return std::move(future);
+#else
+        push({std::move(job)});
+#endif
+    }
+
+    /**
+     * execute job in a thread discarding its result. no promise is allocated
+     * @param job job to execute
+     */
+    void execute_detached(Executable job) {
+        push({std::move(job)});
+    }
+
+#ifndef YATQ_DISABLE_FUTURES
+    /**
+     * execute job in a thread and store its result straight into the given slot
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     */
+    void execute(Executable job, Slot slot) {
+        push({std::move(job), std::move(slot)});
+    }
+#endif
+
+private:
+    // NB: round-robin among the least loaded workers; an empty ring wins right away. 'nullptr' => all rings are full
+    Worker* choose() {
+        auto num_workers = _workers.size();
+        Worker* chosen = nullptr;
+        std::size_t min_load = Capacity;
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            auto& worker = *_workers[(_next_worker + i) % num_workers];
+            auto load = worker.tail.load(std::memory_order_relaxed) - worker.head.load(std::memory_order_acquire);
+            if (load < min_load) {
+                chosen = &worker;
+                min_load = load;
+                if (load == 0) {
+                    break;
+                }
+            }
+        }
+        _next_worker = (_next_worker + 1) % num_workers;
+        return chosen;
+    }
+
+    void push(QueueEntry&& queue_entry) {
+        if (_workers.empty()) {
+            throw std::logic_error("Handoff executor has never been started");
+        }
+        for (;;) {
+            auto worker = choose();
+            if (worker) {  // NB: its ring has room: only its worker drains it meanwhile
+                auto tail = worker->tail.load(std::memory_order_relaxed);
+                worker->ring[tail & (Capacity - 1)] = std::move(queue_entry);
+                worker->tail.store(tail + 1, std::memory_order_release);
+                std::atomic_thread_fence(std::memory_order_seq_cst);  // NB: pairs with the fence in 'park()'
+                if (worker->state.load(std::memory_order_relaxed) == PARKED) {
+                    wake(*worker);
+                }
+                return;
+            }
+            std::this_thread::yield();  // NB: all rings are full
+        }
+    }
+
+    static void wake(Worker& worker) {
+        worker.state.store(RUNNING, std::memory_order_relaxed);
+        worker.state.notify_one();
+    }
+
+    void park(Worker& worker, std::size_t head) {
+        worker.state.store(PARKED, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (worker.tail.load(std::memory_order_acquire) == head && _running) {
+            worker.state.wait(PARKED, std::memory_order_acquire);
+        }
+        worker.state.store(RUNNING, std::memory_order_relaxed);
+    }
+
+    void thread_routine(std::size_t index, std::string&& thread_tag) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.handoff_executor");
+#endif
+
+        SET_THREAD_TAG(thread_tag);
+        LOG4CXX_INFO(logger, "Start");
+
+        auto& worker = *_workers[index];
+        auto head = worker.head.load(std::memory_order_relaxed);
+        int spins = 0;
+        while (_running) {
+            if (worker.tail.load(std::memory_order_acquire) == head) {
+                if (++spins < spin_count) {
+                    continue;
+                }
+                spins = 0;
+                park(worker, head);
+                continue;
+            }
+            spins = 0;
+            auto queue_entry = std::move(worker.ring[head & (Capacity - 1)]);
+            worker.head.store(++head, std::memory_order_release);
+
+            LOG4CXX_TRACE(logger, "Start job");
+#ifndef YATQ_DISABLE_FUTURES
+            if (queue_entry.slot) {
+                internal::run_and_complete<result_type>(queue_entry.job, queue_entry.slot);
+            }
+            else {
+                run_detached(queue_entry.job);
+            }
+#else
+            run_detached(queue_entry.job);
+#endif
+            LOG4CXX_TRACE(logger, "Job complete");
+        }
+
+        LOG4CXX_INFO(logger, "Stop");
+    }
+
+    static void run_detached(Executable& job) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.handoff_executor");
+#endif
+
+        try {
+            job();
+        }
+        catch (const std::exception& exc) {
+            LOG4CXX_WARN(logger, std::format("Detached job failed: {}", exc.what()));
+        }
+        catch (...) {
+            LOG4CXX_WARN(logger, "Detached job failed");
+        }
+    }
+};
+
+}
+
+#endif
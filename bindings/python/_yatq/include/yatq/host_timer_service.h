@@ -0,0 +1,600 @@
+#ifndef _YATQ_HOST_TIMER_SERVICE_H
+#define _YATQ_HOST_TIMER_SERVICE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include "yatq/internal/log4cxx_proxy.h"
+#include "yatq/utils/logging_utils.h"
+#include "yatq/utils/shm_utils.h"
+#ifndef YATQ_DISABLE_PTHREAD
+#include "yatq/utils/sched_utils.h"
+#endif
+#include "yatq/job_registry.h"
+
+namespace yatq {
+
+namespace internal {
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared memory queue needs lock-free atomics");
+
+constexpr std::uint64_t host_timers_magic = 0x3153544851544159;  // NB: "YATQHTS1"
+
+typedef struct {
+    std::int64_t deadline;  // NB: steady clock ticks, the same for all processes on the host
+    std::uint32_t client;
+    std::uint32_t generation;
+    JobDescriptor payload;
+} HostTimer;
+
+struct HostRequestCell {
+    std::atomic<std::uint64_t> sequence;
+    HostTimer timer;
+};
+
+typedef struct {
+    std::uint32_t generation;
+    JobDescriptor payload;
+} HostDelivery;
+
+// NB: deliveries: single producer (the service), single consumer (the client); requests: the client threads produce,
+// the service consumes. followed by the deliveries ring, then the requests ring
+struct HostMailbox {
+    std::atomic<std::int32_t> pid;  // NB: 0 => free
+    std::atomic<std::uint32_t> generation;  // NB: bumped by every new owner
+    std::atomic<std::uint32_t> wake;  // NB: futex word
+    std::atomic<std::uint32_t> waiting;
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+    alignas(64) std::atomic<std::uint64_t> request_pos;
+    std::atomic<std::uint64_t> request_base;  // NB: 'request_pos' when the current owner took the slot
+};
+
+struct HostTimersHeader {
+    std::atomic<std::uint64_t> magic;  // NB: set last => the rest is initialized
+    std::uint32_t max_clients;
+    std::uint32_t queue_capacity;
+    std::uint32_t mailbox_capacity;
+    std::atomic<std::uint32_t> wake;  // NB: futex word
+    std::atomic<std::uint32_t> sleeping;
+};
+
+// shared memory layout: header, then a mailbox per client with its deliveries ring and its requests ring (bounded
+// multi-producer queue). a request ring per client => a process dying in the middle of an enqueue stalls its own ring
+// only
+class HostTimersSegment {
+private:
+    std::byte* _base;
+
+public:
+    explicit HostTimersSegment(std::byte* base = nullptr) noexcept: _base(base) {}
+
+    static std::size_t round_up(std::size_t size) noexcept {
+        return (size + 63) / 64 * 64;
+    }
+
+    static std::size_t deliveries_size(std::size_t mailbox_capacity) noexcept {
+        return round_up(sizeof(HostMailbox) + mailbox_capacity * sizeof(HostDelivery));
+    }
+
+    static std::size_t client_stride(std::size_t queue_capacity, std::size_t mailbox_capacity) noexcept {
+        return deliveries_size(mailbox_capacity) + round_up(queue_capacity * sizeof(HostRequestCell));
+    }
+
+    static std::size_t size(std::size_t max_clients, std::size_t queue_capacity, std::size_t mailbox_capacity) noexcept {
+        return round_up(sizeof(HostTimersHeader)) + max_clients * client_stride(queue_capacity, mailbox_capacity);
+    }
+
+    HostTimersHeader& header() const noexcept {
+        return *std::launder(reinterpret_cast<HostTimersHeader*>(_base));
+    }
+
+    HostMailbox& mailbox(std::size_t client) const noexcept {
+        auto mailboxes = _base + round_up(sizeof(HostTimersHeader));
+        auto stride = client_stride(header().queue_capacity, header().mailbox_capacity);
+        return *std::launder(reinterpret_cast<HostMailbox*>(mailboxes + client * stride));
+    }
+
+    HostRequestCell& cell(std::size_t client, std::uint64_t pos) const noexcept {
+        auto cells = reinterpret_cast<std::byte*>(&mailbox(client)) + deliveries_size(header().mailbox_capacity);
+        auto i = pos & (header().queue_capacity - 1);
+        return *std::launder(reinterpret_cast<HostRequestCell*>(cells + i * sizeof(HostRequestCell)));
+    }
+
+    HostDelivery* deliveries(std::size_t client) const noexcept {
+        return reinterpret_cast<HostDelivery*>(reinterpret_cast<std::byte*>(&mailbox(client)) + sizeof(HostMailbox));
+    }
+};
+
+}
+
+/**
+ * host timer service counters
+ */
+typedef struct {
+    std::size_t received;
+    std::size_t delivered;
+    std::size_t dropped;  // NB: for clients gone, including timers left half-enqueued
+    std::size_t wakeups;  // NB: client wake-ups, one per batch at most
+} HostTimerStats;
+
+/**
+ * host-wide timer service: processes on the host (see \a HostTimerClient) enqueue timers into shared memory queues,
+ * one per process, instead of running a timer queue thread each. a single thread keeps the timers in a heap and delivers the expired
+ * ones to per-process mailboxes, waking a process (by futex) once per batch. a timer is a trivially copyable payload
+ * (see \a JobDescriptor) plus a \a std::chrono::steady_clock deadline, the clock being the same for all processes on the
+ * host. Linux only
+ */
+class HostTimerService {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    using HostTimer = internal::HostTimer;
+    using HostDelivery = internal::HostDelivery;
+
+    utils::SharedMemory _memory;
+    internal::HostTimersSegment _segment;
+    std::atomic<bool> _running;
+    std::thread _thread;
+    std::vector<HostTimer> _heap;  // NB: below fields are touched by the service thread only
+    std::vector<std::uint64_t> _request_pos;  // NB: next request to take, by client
+    std::vector<std::vector<HostDelivery>> _backlog;  // NB: deliveries not fitting mailboxes, by client
+    std::vector<std::size_t> _batch;  // NB: batch size by client
+    std::atomic<std::size_t> _received;
+    std::atomic<std::size_t> _delivered;
+    std::atomic<std::size_t> _dropped;
+    std::atomic<std::size_t> _wakeups;
+
+public:
+    /**
+     * create service shared memory, replacing a stale one of the same name
+     * @param name shared memory object name, e.g. "/app_timers"
+     * @param max_clients max number of client processes
+     * @param queue_capacity max number of timers a client has submitted and the service thread has not yet taken;
+     * power of 2
+     * @param mailbox_capacity max number of expired timers waiting for a client; power of 2
+     */
+    explicit HostTimerService(
+        const std::string& name,
+        std::size_t max_clients = 64,
+        std::size_t queue_capacity = 4096,
+        std::size_t mailbox_capacity = 4096
+    ):
+        _memory(
+            name,
+            internal::HostTimersSegment::size(
+                max_clients,
+                checked_capacity(queue_capacity, "Queue"),
+                checked_capacity(mailbox_capacity, "Mailbox")
+            )
+        ),
+        _segment(_memory.data()),
+        _running(false),
+        _request_pos(max_clients, 0),
+        _backlog(max_clients),
+        _batch(max_clients, 0),
+        _received(0),
+        _delivered(0),
+        _dropped(0),
+        _wakeups(0) {
+        auto header = new (_memory.data()) internal::HostTimersHeader;
+        header->max_clients = static_cast<std::uint32_t>(max_clients);
+        header->queue_capacity = static_cast<std::uint32_t>(queue_capacity);
+        header->mailbox_capacity = static_cast<std::uint32_t>(mailbox_capacity);
+        header->wake.store(0, std::memory_order_relaxed);
+        header->sleeping.store(0, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < max_clients; ++i) {
+            auto mailbox = new (&_segment.mailbox(i)) internal::HostMailbox;
+            mailbox->pid.store(0, std::memory_order_relaxed);
+            mailbox->generation.store(0, std::memory_order_relaxed);
+            mailbox->wake.store(0, std::memory_order_relaxed);
+            mailbox->waiting.store(0, std::memory_order_relaxed);
+            mailbox->head.store(0, std::memory_order_relaxed);
+            mailbox->tail.store(0, std::memory_order_relaxed);
+            mailbox->request_pos.store(0, std::memory_order_relaxed);
+            mailbox->request_base.store(0, std::memory_order_relaxed);
+            for (std::size_t j = 0; j < queue_capacity; ++j) {
+                auto cell = new (&_segment.cell(i, j)) internal::HostRequestCell;
+                cell->sequence.store(j, std::memory_order_relaxed);
+            }
+        }
+        header->magic.store(internal::host_timers_magic, std::memory_order_release);
+    }
+
+    HostTimerService(const HostTimerService&) = delete;
+    HostTimerService& operator=(const HostTimerService&) = delete;
+
+    ~HostTimerService() {
+        stop();
+    }
+
+    /**
+     * start service thread with default scheduling parameters
+     */
+    void start() {
+        if (!_running.exchange(true)) {
+            _thread = std::thread(&HostTimerService::demux, this);
+        }
+    }
+
+#ifndef YATQ_DISABLE_PTHREAD
+    /**
+     * start service thread with specified scheduling policy and priority
+     * @param sched_policy \a SCHED_OTHER | \a SCHED_RR | \a SCHED_FIFO
+     * @param priority \a yatq::utils::max_priority | \a yatq::utils::min_priority
+     */
+    void start(int sched_policy, utils::priority_t priority = utils::max_priority) {
+        start();
+        utils::set_sched_params(_thread.native_handle(), sched_policy, priority, "host_timers");
+    }
+
+    /**
+     * start service thread with specified scheduling policy and priority
+     * @param sched_policy \a SCHED_OTHER | \a SCHED_RR | \a SCHED_FIFO
+     * @param priority explicit priority
+     */
+    void start(int sched_policy, int priority) {
+        start();
+        utils::set_sched_params(_thread.native_handle(), sched_policy, priority, "host_timers");
+    }
+#endif
+
+    /**
+     * stop service thread. pending timers are kept until it is started again
+     */
+    void stop() {
+        if (_running.exchange(false)) {
+            auto& header = _segment.header();
+            header.wake.fetch_add(1, std::memory_order_seq_cst);
+            utils::futex_wake(header.wake);
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+        }
+    }
+
+    /**
+     * @return received, delivered and dropped timer counts and client wake-ups so far
+     */
+    HostTimerStats stats() const noexcept {
+        return {
+            _received.load(std::memory_order_relaxed),
+            _delivered.load(std::memory_order_relaxed),
+            _dropped.load(std::memory_order_relaxed),
+            _wakeups.load(std::memory_order_relaxed)
+        };
+    }
+
+private:
+    static std::size_t checked_capacity(std::size_t capacity, const char* what) {
+        if (!std::has_single_bit(capacity) || capacity > UINT32_MAX) {
+            throw std::invalid_argument(std::format("{} capacity must be a power of 2", what));
+        }
+        return capacity;
+    }
+
+    static bool heap_cmp(const HostTimer& lhs, const HostTimer& rhs) {
+        return lhs.deadline > rhs.deadline;
+    }
+
+    // NB: take the next request of the client, if any
+    bool receive(std::uint32_t client) {
+        auto& pos = _request_pos[client];
+        auto& cell = _segment.cell(client, pos);
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence == pos + 1) {
+            _heap.push_back(cell.timer);
+            std::push_heap(_heap.begin(), _heap.end(), HostTimerService::heap_cmp);
+            _received.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (sequence == pos && pos < _segment.mailbox(client).request_base.load(std::memory_order_acquire)) {
+            // NB: claimed by a previous owner gone before publishing it => never going to be published
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            return false;
+        }
+        cell.sequence.store(pos + _segment.header().queue_capacity, std::memory_order_release);
+        ++pos;
+        return true;
+    }
+
+    // NB: whether a client has published a request not taken yet
+    bool requested() const {
+        auto max_clients = _segment.header().max_clients;
+        for (std::uint32_t client = 0; client < max_clients; ++client) {
+            auto pos = _request_pos[client];
+            if (_segment.cell(client, pos).sequence.load(std::memory_order_acquire) == pos + 1) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool alive(std::uint32_t client, std::uint32_t generation) const {
+        auto& mailbox = _segment.mailbox(client);
+        return mailbox.pid.load(std::memory_order_acquire) != 0 &&
+            mailbox.generation.load(std::memory_order_acquire) == generation;
+    }
+
+    // NB: whether the client process is gone without releasing its slot. a system call => only for full mailboxes
+    bool gone(std::uint32_t client) const {
+        auto pid = _segment.mailbox(client).pid.load(std::memory_order_acquire);
+        return pid != 0 && ::kill(pid, 0) != 0 && errno == ESRCH;
+    }
+
+    // NB: move the client backlog to its mailbox as far as it fits
+    void deliver(std::uint32_t client) {
+        auto& mailbox = _segment.mailbox(client);
+        auto& backlog = _backlog[client];
+        auto deliveries = _segment.deliveries(client);
+        auto capacity = _segment.header().mailbox_capacity;
+        auto head = mailbox.head.load(std::memory_order_relaxed);
+        auto tail = mailbox.tail.load(std::memory_order_acquire);
+        auto count = std::min<std::size_t>(backlog.size(), capacity - (head - tail));
+        for (std::size_t i = 0; i < count; ++i) {
+            deliveries[(head + i) & (capacity - 1)] = backlog[i];
+        }
+        if (count == 0) {
+            return;
+        }
+        backlog.erase(backlog.begin(), backlog.begin() + count);
+        mailbox.head.store(head + count, std::memory_order_release);
+        _delivered.fetch_add(count, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // NB: pairs with the fence in 'HostTimerClient::wait()'
+        if (mailbox.waiting.load(std::memory_order_relaxed)) {
+            mailbox.wake.fetch_add(1, std::memory_order_relaxed);
+            utils::futex_wake(mailbox.wake);
+            _wakeups.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // NB: returns whether deliveries are still pending
+    bool flush(const Clock::time_point& now) {
+        auto max_clients = _segment.header().max_clients;
+        std::fill(_batch.begin(), _batch.end(), 0);
+        auto deadline = now.time_since_epoch().count();
+        while (!_heap.empty() && _heap.front().deadline <= deadline) {
+            std::pop_heap(_heap.begin(), _heap.end(), HostTimerService::heap_cmp);
+            auto& timer = _heap.back();
+            if (timer.client < max_clients && alive(timer.client, timer.generation)) {
+                _backlog[timer.client].push_back(HostDelivery {timer.generation, timer.payload});
+                ++_batch[timer.client];
+            }
+            else {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            _heap.pop_back();
+        }
+        bool pending = false;
+        for (std::uint32_t client = 0; client < max_clients; ++client) {
+            auto& backlog = _backlog[client];
+            if (backlog.empty()) {
+                continue;
+            }
+            if (_batch[client] == 0 && !alive(client, backlog.front().generation)) {
+                _dropped.fetch_add(backlog.size(), std::memory_order_relaxed);
+                backlog.clear();
+                continue;
+            }
+            deliver(client);
+            if (!backlog.empty() && gone(client)) {
+                // NB: the mailbox is full, and nobody is going to empty it
+                _dropped.fetch_add(backlog.size(), std::memory_order_relaxed);
+                backlog.clear();
+            }
+            pending = pending || !backlog.empty();
+        }
+        return pending;
+    }
+
+    void demux() {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.host_timer_service");
+#endif
+
+        SET_THREAD_TAG("host_timers");
+        LOG4CXX_INFO(logger, "Start");
+
+        auto& header = _segment.header();
+        while (_running.load(std::memory_order_relaxed)) {
+            for (std::uint32_t client = 0; client < header.max_clients; ++client) {
+                while (receive(client)) {}
+            }
+
+            auto now = Clock::now();
+            bool pending = flush(now);
+
+            auto wake = header.wake.load(std::memory_order_acquire);
+            header.sleeping.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);  // NB: pairs with the fence in 'HostTimerClient::enqueue()'
+            if (requested()) {
+                header.sleeping.store(0, std::memory_order_relaxed);
+                continue;
+            }
+            auto timeout = std::chrono::nanoseconds(-1);
+            if (!_heap.empty()) {
+                timeout = std::max(Clock::duration(_heap.front().deadline) - now.time_since_epoch(), Clock::duration::zero());
+            }
+            if (pending) {
+                // NB: a client mailbox is full => retry shortly
+                auto retry = std::chrono::milliseconds(1);
+                timeout = (timeout < std::chrono::nanoseconds::zero()) ? retry : std::min<std::chrono::nanoseconds>(timeout, retry);
+            }
+            if (timeout != std::chrono::nanoseconds::zero()) {
+                LOG4CXX_TRACE(logger, std::format("Wait for {} ns", timeout.count()));
+                utils::futex_wait(header.wake, wake, timeout);
+            }
+            header.sleeping.store(0, std::memory_order_relaxed);
+        }
+
+        LOG4CXX_INFO(logger, "Stop");
+    }
+};
+
+/**
+ * client of the host timer service (see \a HostTimerService). takes a mailbox slot for the process lifetime. not thread
+ * safe, except \a enqueue() that may be called concurrently
+ */
+class HostTimerClient {
+public:
+    using Clock = HostTimerService::Clock;
+
+private:
+    utils::SharedMemory _memory;
+    internal::HostTimersSegment _segment;
+    std::uint32_t _client;
+    std::uint32_t _generation;
+
+public:
+    /**
+     * attach to the service and take a free mailbox slot, or one of a process gone
+     * @param name shared memory object name
+     */
+    explicit HostTimerClient(const std::string& name): _memory(name), _segment(_memory.data()) {
+        if (
+            _memory.size() < sizeof(internal::HostTimersHeader) ||
+            _segment.header().magic.load(std::memory_order_acquire) != internal::host_timers_magic
+        ) {
+            throw std::runtime_error("Host timer service " + name + " is not ready");
+        }
+        auto pid = static_cast<std::int32_t>(::getpid());
+        auto max_clients = _segment.header().max_clients;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (std::uint32_t client = 0; client < max_clients; ++client) {
+                auto& mailbox = _segment.mailbox(client);
+                auto owner = mailbox.pid.load(std::memory_order_relaxed);
+                // NB: the second pass takes slots of processes gone without releasing them
+                bool is_free = (owner == 0) || (pass == 1 && ::kill(owner, 0) != 0 && errno == ESRCH);
+                if (is_free && mailbox.pid.compare_exchange_strong(owner, pid, std::memory_order_acq_rel)) {
+                    _client = client;
+                    // NB: requests below are the previous owner's => the service may skip those it left unpublished
+                    mailbox.request_base.store(mailbox.request_pos.load(std::memory_order_relaxed), std::memory_order_release);
+                    _generation = mailbox.generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+                    return;
+                }
+            }
+        }
+        throw std::runtime_error("No free client slot in host timer service " + name);
+    }
+
+    HostTimerClient(const HostTimerClient&) = delete;
+    HostTimerClient& operator=(const HostTimerClient&) = delete;
+
+    ~HostTimerClient() {
+        _segment.mailbox(_client).pid.store(0, std::memory_order_release);
+    }
+
+    /**
+     * @return mailbox slot taken
+     */
+    std::uint32_t client() const noexcept {
+        return _client;
+    }
+
+    /**
+     * add timer. throws \a std::runtime_error if the queue of this process is full
+     * @param deadline expiration timepoint
+     * @param payload delivered to this process on expiration
+     */
+    void enqueue(const Clock::time_point& deadline, const JobDescriptor& payload) {
+        auto& header = _segment.header();
+        auto& mailbox = _segment.mailbox(_client);
+        auto pos = mailbox.request_pos.load(std::memory_order_relaxed);
+        while (true) {
+            auto& cell = _segment.cell(_client, pos);
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::int64_t>(sequence - pos);
+            if (diff == 0) {
+                if (mailbox.request_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.timer = internal::HostTimer {deadline.time_since_epoch().count(), _client, _generation, payload};
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                throw std::runtime_error("Host timer service queue is full");
+            }
+            else {
+                pos = mailbox.request_pos.load(std::memory_order_relaxed);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // NB: pairs with the fence in 'HostTimerService::demux()'
+        if (header.sleeping.load(std::memory_order_relaxed)) {
+            header.wake.fetch_add(1, std::memory_order_relaxed);
+            utils::futex_wake(header.wake, 1);
+        }
+    }
+
+    /**
+     * take expired timers without blocking
+     * @param handler callable; \a void(const JobDescriptor&)
+     * @return number of timers taken
+     */
+    template<typename F>
+    std::size_t poll(F&& handler) {
+        auto& mailbox = _segment.mailbox(_client);
+        auto deliveries = _segment.deliveries(_client);
+        auto capacity = _segment.header().mailbox_capacity;
+        auto tail = mailbox.tail.load(std::memory_order_relaxed);
+        auto head = mailbox.head.load(std::memory_order_acquire);
+        std::size_t count = 0;
+        for (; tail != head; ++tail) {
+            auto delivery = deliveries[tail & (capacity - 1)];
+            mailbox.tail.store(tail + 1, std::memory_order_release);  // NB: before the handler => the slot is free even if it throws
+            if (delivery.generation == _generation) {  // NB: skip leftovers of a previous owner
+                ++count;
+                handler(delivery.payload);
+            }
+        }
+        return count;
+    }
+
+    /**
+     * take expired timers, waiting for at least one up to the timeout
+     * @param handler callable; \a void(const JobDescriptor&)
+     * @param timeout max wait time
+     * @return number of timers taken; 0 => timeout
+     */
+    template<typename F>
+    std::size_t wait(F&& handler, const Clock::duration& timeout) {
+        auto& mailbox = _segment.mailbox(_client);
+        auto deadline = Clock::now() + timeout;
+        while (true) {
+            auto wake = mailbox.wake.load(std::memory_order_acquire);
+            if (auto count = poll(handler); count > 0) {
+                return count;
+            }
+            auto now = Clock::now();
+            if (now >= deadline) {
+                return 0;
+            }
+            mailbox.waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);  // NB: pairs with the fence in 'HostTimerService::deliver()'
+            if (mailbox.head.load(std::memory_order_acquire) == mailbox.tail.load(std::memory_order_relaxed)) {
+                utils::futex_wait(mailbox.wake, wake, deadline - now);
+            }
+            mailbox.waiting.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+}
+
+#endif
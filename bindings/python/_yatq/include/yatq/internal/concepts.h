@@ -1,8 +1,13 @@
 #ifndef _YATQ_INTERNAL_CONCEPTS_H
 #define _YATQ_INTERNAL_CONCEPTS_H
 
+#include <atomic>
 #include <chrono>
 #include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
 
 namespace yatq::internal {
 
@@ -23,36 +28,180 @@ concept ClockGeneric = requires (Clock::time_point t1, Clock::time_point t2) {
 #endif
 };
 
-template<typename Executable>
-concept ExecutableGeneric = requires {
-    typename Executable::result_type;
-    std::invocable<Executable>;
-    std::movable<Executable>;
+template<typename Sync>
+concept SyncGeneric = requires {
+    typename Sync::mutex;
+    typename Sync::condition_variable;
+};
+
+// job queue policy: 'Queue::queue<T, Sync>' is a multi-producer multi-consumer queue of 'T'
+template<typename Queue, typename Sync>
+concept QueueGeneric = requires(Queue::template queue<int, Sync> queue, int value, const std::atomic<bool>& running) {
+    queue.push(std::move(value));
+    { queue.try_push(std::move(value)) } -> std::convertible_to<bool>;
+    { queue.try_pop(value) } -> std::convertible_to<bool>;
+    { queue.pop(value, running) } -> std::convertible_to<bool>;
+    queue.wake_all();
+};
+
+// job queue policy whose consumers may give up waiting at a deadline
+template<typename Queue, typename Sync>
+concept TimedQueueGeneric =
+        QueueGeneric<Queue, Sync> &&
+        requires(
+            Queue::template queue<int, Sync> queue,
+            int value,
+            const std::atomic<bool>& running,
+            std::chrono::steady_clock::time_point deadline
+        ) {
+    { queue.pop(value, running, deadline) } -> std::convertible_to<bool>;
+};
+
+// job queue policy ordering its elements by their 'deadline' member
+template<typename Queue>
+concept DeadlineQueueGeneric = requires {
+    requires Queue::earliest_deadline_first;
 };
 
+// NB: no nested 'result_type' required so that e.g. 'std::move_only_function' fits
+template<typename Executable>
+using executable_result_t = std::invoke_result_t<Executable&>;
+
+template<typename Executable>
+concept ExecutableGeneric = std::invocable<Executable&> && std::movable<Executable>;
+
 #ifndef YATQ_DISABLE_FUTURES
+// NB: the timer queue chains a continuation per fired timer => 'then()' shall run it inline, not in a new thread
 template<typename Future, typename result_type>
 concept ChainableFutureGeneric = requires(Future future, void (*then) (Future)) {
     std::movable<Future>;
     { future.get() } -> std::convertible_to<result_type>;
     future.then(then);
 };
+
+// how a continuation is chained to an executor future; specialized for 'boost::future' (launched 'sync', its default
+// policy being 'async') in <yatq/utils/boost_future_utils.h>
+template<typename Future>
+struct FutureChain {
+    template<typename F>
+    static void then(Future& future, F&& func) {
+        future.then(std::forward<F>(func));
+    }
+};
 #endif
 
 template<typename Executor>
 concept ExecutorGeneric =
 #ifndef YATQ_DISABLE_FUTURES
-        ChainableFutureGeneric<typename Executor::Future, typename Executor::Executable::result_type> &&
+        ChainableFutureGeneric<typename Executor::Future, executable_result_t<typename Executor::Executable>> &&
 #endif
+        ExecutableGeneric<typename Executor::Executable> &&
         requires(Executor executor, Executor::Executable job) {
-    typename Executor::Executable;
-    typename Executor::Executable::result_type;
-    std::movable<typename Executor::Executable>;
 #ifndef YATQ_DISABLE_FUTURES
     typename Executor::Future;
-    { executor.execute(job) } -> std::convertible_to<typename Executor::Future>;
+    { executor.execute(std::move(job)) } -> std::convertible_to<typename Executor::Future>;
+#else
+    executor.execute(std::move(job));
+#endif
+};
+
+#ifndef YATQ_DISABLE_FUTURES
+// executor able to store job result straight into a given completion slot (see <yatq/completion.h>)
+template<typename Executor>
+concept CompletionExecutorGeneric =
+        ExecutorGeneric<Executor> &&
+        requires(Executor executor, Executor::Executable job, Executor::Slot slot) {
+    executor.execute(std::move(job), std::move(slot));
+};
+#endif
+
+// executor able to refuse a job instead of blocking the submitter (see 'ThreadPool::try_execute()')
+template<typename Executor>
+concept TryExecutorGeneric = requires(
+    Executor executor,
+#ifndef YATQ_DISABLE_FUTURES
+    Executor::Slot slot,
+#endif
+    Executor::Executable job
+) {
+#ifndef YATQ_DISABLE_FUTURES
+    executor.try_execute(std::move(job), std::move(slot));
+#else
+    executor.try_execute(std::move(job));
+#endif
+};
+
+// executor able to resume coroutines in its threads
+template<typename Executor>
+concept ResumingExecutorGeneric = requires(Executor executor, std::coroutine_handle<> handle) {
+    executor.resume(handle);
+};
+
+// executor able to order jobs by their deadlines (see 'ThreadPool' with 'utils::DeadlineQueue')
+template<typename Executor>
+concept DeadlineExecutorGeneric = requires(
+    Executor executor,
+    Executor::Executable job,
+#ifndef YATQ_DISABLE_FUTURES
+    Executor::Slot slot,
+#endif
+    std::chrono::steady_clock::time_point deadline
+) {
+#ifndef YATQ_DISABLE_FUTURES
+    executor.execute(std::move(job), std::move(slot), deadline);
+#else
+    executor.execute(std::move(job), deadline);
+#endif
+};
+
+// executor running jobs with the same key in order (see 'KeyedThreadPool')
+template<typename Executor>
+concept KeyedExecutorGeneric = requires(
+    Executor executor,
+    Executor::Executable job,
+#ifndef YATQ_DISABLE_FUTURES
+    Executor::Slot slot,
+#endif
+    std::size_t key
+) {
+#ifndef YATQ_DISABLE_FUTURES
+    executor.execute(key, std::move(job), std::move(slot));
+#else
+    executor.execute(key, std::move(job));
+#endif
+};
+
+// executor able to run cheap jobs inline in the calling thread (see 'HybridExecutor')
+template<typename Executor>
+concept InlineExecutorGeneric = requires(
+    Executor executor,
+    Executor::Executable job,
+#ifndef YATQ_DISABLE_FUTURES
+    Executor::Slot slot,
+#endif
+    std::size_t kind
+) {
+#ifndef YATQ_DISABLE_FUTURES
+    executor.execute_inline(kind, std::move(job), std::move(slot));
+#else
+    executor.execute_inline(kind, std::move(job));
+#endif
+};
+
+// executor able to take a job ahead of time and hold it until a deadline (see 'ThreadPool::stage()')
+template<typename Executor>
+concept StagingExecutorGeneric = requires(
+    Executor executor,
+    Executor::Executable job,
+#ifndef YATQ_DISABLE_FUTURES
+    Executor::Slot slot,
+#endif
+    std::chrono::steady_clock::time_point deadline
+) {
+#ifndef YATQ_DISABLE_FUTURES
+    executor.stage(std::move(job), std::move(slot), deadline);
 #else
-    executor.execute(job);
+    executor.stage(std::move(job), deadline);
 #endif
 };
 
@@ -0,0 +1,60 @@
+#ifndef _YATQ_INTERNAL_COROUTINE_UTILS_H
+#define _YATQ_INTERNAL_COROUTINE_UTILS_H
+
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+namespace yatq::internal {
+
+/**
+ * eagerly started coroutine destroying itself upon completion
+ */
+struct DetachedCoroutine {
+    struct promise_type {
+        DetachedCoroutine get_return_object() noexcept {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+};
+
+template<typename Awaitable>
+decltype(auto) get_awaiter(Awaitable&& awaitable) {
+    if constexpr (requires { std::forward<Awaitable>(awaitable).operator co_await(); }) {
+        return std::forward<Awaitable>(awaitable).operator co_await();
+    }
+    else if constexpr (requires { operator co_await(std::forward<Awaitable>(awaitable)); }) {
+        return operator co_await(std::forward<Awaitable>(awaitable));
+    }
+    else {
+        return std::forward<Awaitable>(awaitable);
+    }
+}
+
+template<typename Awaitable>
+using await_result_t = decltype(get_awaiter(std::declval<Awaitable>()).await_resume());
+
+// timer queue entry of a suspended coroutine
+typedef struct {
+    std::coroutine_handle<> handle;
+    bool canceled;
+} SleepState;
+
+}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef _YATQ_INTERNAL_SPIN_UTILS_H
+#define _YATQ_INTERNAL_SPIN_UTILS_H
+
+#include <chrono>
+
+namespace yatq::internal {
+
+// busy-wait hint: lets the sibling hyper-thread run and saves power while spinning
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// NB: burns the CPU; keep the distance to 'deadline' short
+template<typename Clock, typename Duration>
+void spin_until(const std::chrono::time_point<Clock, Duration>& deadline) noexcept {
+    while (Clock::now() < deadline) {
+        cpu_relax();
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef _YATQ_JOB_REGISTRY_H
+#define _YATQ_JOB_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+#include "yatq/internal/concepts.h"
+#include "yatq/move_only_function.h"
+
+namespace yatq {
+
+using internal::ExecutableGeneric;
+
+/**
+ * max size of a job descriptor payload
+ */
+constexpr std::size_t job_payload_size = 48;
+
+/**
+ * serializable job: registered job type plus trivially copyable payload, e.g. a session id. see \a JobRegistry and
+ * \a make_job_descriptor()
+ */
+typedef struct {
+    std::uint32_t type;
+    std::uint32_t size;
+    alignas(8) std::byte payload[job_payload_size];
+} JobDescriptor;
+
+/**
+ * @param type registered job type
+ * @param payload job parameters; trivially copyable, at most \a job_payload_size bytes
+ * @return job descriptor
+ */
+template<typename Payload>
+JobDescriptor make_job_descriptor(std::uint32_t type, const Payload& payload) {
+    static_assert(std::is_trivially_copyable_v<Payload>, "Job payload must be trivially copyable");
+    static_assert(sizeof(Payload) <= job_payload_size, "Job payload is too large");
+    JobDescriptor descriptor {type, sizeof(Payload), {}};
+    std::memcpy(descriptor.payload, &payload, sizeof(Payload));
+    return descriptor;
+}
+
+/**
+ * job factories by job type: turns job descriptors back into jobs, e.g. when restoring a timer queue snapshot. not thread
+ * safe: register job types before use
+ */
+template<ExecutableGeneric _Executable = MoveOnlyFunction<void(void)>>
+class JobRegistry {
+public:
+    using Executable = _Executable;
+    using Factory = MoveOnlyFunction<Executable(const JobDescriptor&)>;
+
+private:
+    std::unordered_map<std::uint32_t, Factory> _factories;
+
+public:
+    /**
+     * register job type
+     * @param type job type
+     * @param factory callable; \a Executable(const Payload&)
+     */
+    template<typename Payload, typename F>
+    void add(std::uint32_t type, F&& factory) {
+        static_assert(std::is_trivially_copyable_v<Payload>, "Job payload must be trivially copyable");
+        static_assert(sizeof(Payload) <= job_payload_size, "Job payload is too large");
+        _factories.insert_or_assign(
+            type,
+            [factory = std::forward<F>(factory)] (const JobDescriptor& descriptor) mutable -> Executable {
+                if (descriptor.size != sizeof(Payload)) {
+                    throw std::invalid_argument(std::format("Job type {} payload size mismatch", descriptor.type));
+                }
+                Payload payload;
+                std::memcpy(&payload, descriptor.payload, sizeof(Payload));
+                return factory(payload);
+            }
+        );
+    }
+
+    /**
+     * @return whether the job type is registered
+     */
+    bool contains(std::uint32_t type) const {
+        return _factories.contains(type);
+    }
+
+    /**
+     * make job from its descriptor
+     * @param descriptor job descriptor
+     * @return job
+     */
+    Executable make(const JobDescriptor& descriptor) {
+        auto i = _factories.find(descriptor.type);
+        if (i == _factories.end()) {
+            throw std::out_of_range(std::format("Job type {} is not registered", descriptor.type));
+        }
+        return i->second(descriptor);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,418 @@
+#ifndef _YATQ_KEYED_THREAD_POOL_H
+#define _YATQ_KEYED_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "yatq/internal/concepts.h"
+#include "yatq/internal/log4cxx_proxy.h"
+#include "yatq/utils/logging_utils.h"
+#include "yatq/utils/sync_utils.h"
+#ifndef YATQ_DISABLE_FUTURES
+#include "yatq/completion.h"
+#endif
+#include "yatq/move_only_function.h"
+
+namespace yatq {
+
+using internal::ExecutableGeneric;
+using internal::SyncGeneric;
+
+/**
+ * thread pool with a job queue per thread and key affinity: jobs submitted with the same key run in one thread in
+ * submission order, so per-key state stays cache-hot and needs no lock. keys are hashed into a fixed number of buckets
+ * spread over the threads; with rebalancing on (see \a set_rebalance()) a bucket with no job in flight moves off a hot
+ * thread, which keeps the per-key order. jobs without a key are distributed round-robin. jobs cannot be submitted before
+ * the first \a start()
+ */
+template<ExecutableGeneric _Executable = MoveOnlyFunction<void(void)>, SyncGeneric _Sync = utils::StdSync>
+class KeyedThreadPool {
+public:
+    using Executable = _Executable;
+    using Sync = _Sync;
+    using result_type = internal::executable_result_t<Executable>;
+#ifndef YATQ_DISABLE_FUTURES
+    using Future = CompletionHandle<result_type>;
+    using Slot = CompletionSlot<result_type>;
+#endif
+
+    using key_t = std::size_t;
+
+private:
+    using Mutex = Sync::mutex;
+    using ConditionVariable = Sync::condition_variable;
+
+    static constexpr std::size_t bucket_bits = 10;
+    static constexpr std::size_t num_buckets = 1 << bucket_bits;
+    static constexpr std::size_t no_bucket = num_buckets;
+
+    typedef struct {
+        Executable job;
+#ifndef YATQ_DISABLE_FUTURES
+        Slot slot;
+#endif
+        std::size_t bucket;
+    } QueueEntry;
+
+    struct Worker {
+        Mutex lock;
+        ConditionVariable cond;
+        std::deque<QueueEntry> queue;
+        std::atomic<std::size_t> load;  // NB: queued and running jobs
+        std::thread thread;
+
+        Worker(): load(0) {}
+    };
+
+    std::atomic<bool> _running;
+    const std::size_t _max_threads;
+    std::unique_ptr<std::unique_ptr<Worker>[]> _workers;  // NB: allocated once => never moves under a submitter
+    std::atomic<std::size_t> _num_workers;  // NB: published after the workers are made
+    // NB: bucket state is worker index (high half) and number of jobs in flight (low half) => moved atomically
+    std::unique_ptr<std::atomic<std::uint64_t>[]> _buckets;
+    std::atomic<std::size_t> _next_worker;
+    std::atomic<std::size_t> _hot_load;
+    std::atomic<std::size_t> _rebalances;
+#ifndef YATQ_DISABLE_FUTURES
+    CompletionPool<result_type, Sync> _completions;
+#endif
+
+public:
+    /**
+     * create thread pool
+     * @param max_threads max number of threads any \a start() may ask for; worker storage is allocated once for that
+     * many, so a restart adding threads does not race with submissions
+     */
+    explicit KeyedThreadPool(std::size_t max_threads = 256):
+        _running(false),
+        _max_threads(max_threads),
+        _workers(new std::unique_ptr<Worker>[max_threads]),
+        _num_workers(0),
+        _next_worker(0),
+        _hot_load(0),
+        _rebalances(0) {}
+
+    /**
+     * start thread pool. buckets are spread over the threads at the first start and again whenever a restart adds
+     * threads (buckets with jobs in flight stay put). queues and the jobs left in them survive \a stop() => a restart
+     * starts as many threads as the largest previous start at least, and \a num_threads only adds threads beyond that.
+     * throws \a std::invalid_argument beyond the max number of threads (see the constructor)
+     * @param num_threads number of threads
+     */
+    void start(std::size_t num_threads) {
+        if (num_threads > _max_threads) {
+            throw std::invalid_argument(std::format("Keyed thread pool is limited to {} threads", _max_threads));
+        }
+        if (!_running) {
+            _running = true;
+            auto prev_num_workers = _num_workers.load(std::memory_order_relaxed);
+            auto num_workers = std::max(prev_num_workers, num_threads);  // NB: queues survive restart
+            for (auto i = prev_num_workers; i < num_workers; ++i) {
+                _workers[i] = std::make_unique<Worker>();
+            }
+            if (!_buckets) {
+                _buckets.reset(new std::atomic<std::uint64_t>[num_buckets]);
+                for (std::size_t i = 0; i < num_buckets; ++i) {
+                    _buckets[i].store(static_cast<std::uint64_t>(i % num_workers) << 32, std::memory_order_relaxed);
+                }
+            }
+            _num_workers.store(num_workers, std::memory_order_release);
+            if (prev_num_workers > 0 && num_workers > prev_num_workers) {
+                for (std::size_t i = 0; i < num_buckets; ++i) {
+                    auto state = _buckets[i].load(std::memory_order_relaxed);
+                    if ((state & 0xffffffffull) == 0) {  // NB: may fail against a concurrent submission => the bucket stays
+                        _buckets[i].compare_exchange_strong(state, static_cast<std::uint64_t>(i % num_workers) << 32, std::memory_order_acq_rel);
+                    }
+                }
+            }
+            for (std::size_t i = 0; i < num_workers; ++i) {
+                std::string thread_tag = std::format("keyed pool thread #{}", i);
+                _workers[i]->thread = std::thread(&KeyedThreadPool::thread_routine, this, i, std::move(thread_tag));
+            }
+        }
+    }
+
+    /**
+     * stop thread pool and join all the threads
+     */
+    void stop() {
+        if (_running) {
+            _running = false;
+            auto num_workers = _num_workers.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < num_workers; ++i) {
+                auto& worker = _workers[i];
+                { std::lock_guard<Mutex> guard(worker->lock); }
+                worker->cond.notify_all();
+                if (worker->thread.joinable()) {
+                    worker->thread.join();
+                }
+            }
+        }
+    }
+
+    /**
+     * move a key bucket with no job in flight off a thread having at least \a hot_load jobs queued or running to the
+     * least loaded thread, provided that one has less than half as many. off by default
+     * @param hot_load thread load to rebalance at; 0 turns rebalancing off
+     */
+    void set_rebalance(std::size_t hot_load) {
+        _hot_load.store(hot_load, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return number of bucket moves so far
+     */
+    std::size_t rebalances() const noexcept {
+        return _rebalances.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * execute job in a thread
+     * @param job job to execute
+     * @return future object. use it to obtain job result
+     */
+#ifndef YATQ_DISABLE_FUTURES
+    Future
+#else
+    void
+#endif
+    execute(Executable job) {
+#ifndef YATQ_DISABLE_FUTURES
+        auto [slot, future] = _completions.make();
+        push(next_worker(), {std::move(job), std::move(slot), no_bucket});
+        return std::move(future);
+#else
+        push(next_worker(), {std::move(job), no_bucket});
+#endif
+    }
+
+    /**
+     * execute job in a thread discarding its result. no promise is allocated
+     * @param job job to execute
+     */
+    void execute_detached(Executable job) {
+#ifndef YATQ_DISABLE_FUTURES
+        push(next_worker(), {std::move(job), Slot(), no_bucket});
+#else
+        push(next_worker(), {std::move(job), no_bucket});
+#endif
+    }
+
+#ifndef YATQ_DISABLE_FUTURES
+    /**
+     * execute job in a thread and store its result straight into the given slot
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     */
+    void execute(Executable job, Slot slot) {
+        push(next_worker(), {std::move(job), std::move(slot), no_bucket});
+    }
+#endif
+
+    /**
+     * execute job in the thread serving the key, after the jobs submitted with the same key before
+     * @param key job key, e.g. session id
+     * @param job job to execute
+     * @return future object. use it to obtain job result
+     */
+#ifndef YATQ_DISABLE_FUTURES
+    Future
+#else
+    void
+#endif
+    execute(key_t key, Executable job) {
+        auto bucket = bucket_of(key);
+#ifndef YATQ_DISABLE_FUTURES
+        auto [slot, future] = _completions.make();
+        push(route(bucket), {std::move(job), std::move(slot), bucket});
+        return std::move(future);
+#else
+        push(route(bucket), {std::move(job), bucket});
+#endif
+    }
+
+    /**
+     * execute job in the thread serving the key discarding its result. no promise is allocated
+     * @param key job key, e.g. session id
+     * @param job job to execute
+     */
+    void execute_detached(key_t key, Executable job) {
+        auto bucket = bucket_of(key);
+#ifndef YATQ_DISABLE_FUTURES
+        push(route(bucket), {std::move(job), Slot(), bucket});
+#else
+        push(route(bucket), {std::move(job), bucket});
+#endif
+    }
+
+#ifndef YATQ_DISABLE_FUTURES
+    /**
+     * execute job in the thread serving the key and store its result straight into the given slot
+     * @param key job key, e.g. session id
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     */
+    void execute(key_t key, Executable job, Slot slot) {
+        auto bucket = bucket_of(key);
+        push(route(bucket), {std::move(job), std::move(slot), bucket});
+    }
+#endif
+
+private:
+    static std::size_t bucket_of(key_t key) {
+        // NB: Fibonacci hashing => sequential keys spread evenly
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(key) * 0x9e3779b97f4a7c15ull) >> (64 - bucket_bits));
+    }
+
+    // NB: returns the number of workers
+    std::size_t check_started() const {
+        auto num_workers = _num_workers.load(std::memory_order_acquire);
+        if (num_workers == 0) {
+            throw std::logic_error("Keyed thread pool has never been started");
+        }
+        return num_workers;
+    }
+
+    std::size_t next_worker() {
+        auto num_workers = check_started();
+        return _next_worker.fetch_add(1, std::memory_order_relaxed) % num_workers;
+    }
+
+    // NB: counts the job in flight and picks its thread in one step => a bucket never moves under a queued job
+    std::size_t route(std::size_t bucket) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.keyed_thread_pool");
+#endif
+
+        auto num_workers = check_started();
+        auto& state = _buckets[bucket];
+        // NB: acquire => a worker added by a restart is visible once a bucket points to it
+        auto current = state.load(std::memory_order_acquire);
+        for (;;) {
+            auto index = static_cast<std::size_t>(current >> 32);
+            auto desired = current + 1;
+            auto target = index;
+            if ((current & 0xffffffffull) == 0) {
+                target = rebalance_target(index, num_workers);
+                desired = (static_cast<std::uint64_t>(target) << 32) | 1;
+            }
+            if (state.compare_exchange_weak(current, desired, std::memory_order_acquire, std::memory_order_acquire)) {
+                if (target != index) {
+                    _rebalances.fetch_add(1, std::memory_order_relaxed);
+                    LOG4CXX_DEBUG(logger, std::format("Moved bucket {} from thread #{} to thread #{}", bucket, index, target));
+                }
+                return target;
+            }
+        }
+    }
+
+    std::size_t rebalance_target(std::size_t index, std::size_t num_workers) const {
+        auto hot_load = _hot_load.load(std::memory_order_relaxed);
+        auto load = _workers[index]->load.load(std::memory_order_relaxed);
+        if (hot_load == 0 || load < hot_load) {
+            return index;
+        }
+        auto target = index;
+        auto min_load = load;
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            auto other_load = _workers[i]->load.load(std::memory_order_relaxed);
+            if (other_load < min_load) {
+                target = i;
+                min_load = other_load;
+            }
+        }
+        return min_load * 2 < load ? target : index;
+    }
+
+    void push(std::size_t index, QueueEntry&& queue_entry) {
+        auto& worker = *_workers[index];
+        worker.load.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<Mutex> guard(worker.lock);
+            worker.queue.push_back(std::move(queue_entry));
+        }
+        worker.cond.notify_one();
+    }
+
+    void thread_routine(std::size_t index, std::string&& thread_tag) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.keyed_thread_pool");
+#endif
+
+        SET_THREAD_TAG(thread_tag);
+        LOG4CXX_INFO(logger, "Start");
+
+        auto& worker = *_workers[index];
+        while (true) {
+            QueueEntry queue_entry;
+            {
+                std::unique_lock<Mutex> guard(worker.lock);
+                worker.cond.wait(guard, [this, &worker] () { return !worker.queue.empty() || !_running; });
+                if (!_running) {
+                    break;
+                }
+                queue_entry = std::move(worker.queue.front());
+                worker.queue.pop_front();
+            }
+
+            run(queue_entry);
+
+            if (queue_entry.bucket != no_bucket) {
+                _buckets[queue_entry.bucket].fetch_sub(1, std::memory_order_release);
+            }
+            worker.load.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        LOG4CXX_INFO(logger, "Stop");
+    }
+
+    static void run(QueueEntry& queue_entry) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.keyed_thread_pool");
+#endif
+
+        LOG4CXX_TRACE(logger, "Start job");
+#ifndef YATQ_DISABLE_FUTURES
+        if (queue_entry.slot) {
+            internal::run_and_complete<result_type>(queue_entry.job, queue_entry.slot);
+        }
+        else {
+            run_detached(queue_entry.job);
+        }
+#else
+        run_detached(queue_entry.job);
+#endif
+        LOG4CXX_TRACE(logger, "Job complete");
+    }
+
+    static void run_detached(Executable& job) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.keyed_thread_pool");
+#endif
+
+        try {
+            job();
+        }
+        catch (const std::exception& exc) {
+            LOG4CXX_WARN(logger, std::format("Detached job failed: {}", exc.what()));
+        }
+        catch (...) {
+            LOG4CXX_WARN(logger, "Detached job failed");
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,449 @@
+#ifndef _YATQ_SCHEDULED_THREAD_POOL_H
+#define _YATQ_SCHEDULED_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <format>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "yatq/internal/concepts.h"
+#include "yatq/internal/log4cxx_proxy.h"
+#include "yatq/utils/logging_utils.h"
+#include "yatq/utils/sync_utils.h"
+#ifndef YATQ_DISABLE_PTHREAD
+#include "yatq/utils/sched_utils.h"
+#endif
+#ifndef YATQ_DISABLE_FUTURES
+#include "yatq/completion.h"
+#endif
+#include "yatq/move_only_function.h"
+
+namespace yatq {
+
+using internal::ClockGeneric;
+using internal::ExecutableGeneric;
+using internal::SyncGeneric;
+
+/**
+ * timer queue and thread pool in one (leader/follower): pool threads take turns waiting on the timer heap. the leader
+ * takes an expired job, promotes a follower to leader and runs the job itself, so there is no handoff between a timer
+ * thread and a worker thread. exposes the same \a enqueue() / \a cancel() API as \a TimerQueue. a timer may be late if
+ * all the threads are busy running jobs
+ */
+template<
+    ExecutableGeneric _Executable = MoveOnlyFunction<void(void)>,
+    ClockGeneric _Clock = std::chrono::system_clock,
+    SyncGeneric _Sync = utils::StdSync
+>
+class ScheduledThreadPool {
+public:
+    using Clock = _Clock;
+    using Executable = _Executable;
+    using Sync = _Sync;
+    using result_type = internal::executable_result_t<Executable>;
+#ifndef YATQ_DISABLE_FUTURES
+    using Future = CompletionHandle<result_type>;
+    using Callback = typename Future::Continuation;
+#endif
+
+    using uid_t = unsigned int;
+
+    typedef struct {
+        /**
+         * opaque timer uid. use it to cancel the timer or to check whether it is still in queue
+         */
+        uid_t uid;
+        /**
+         * scheduled execution timepoint. added for the sake of convenience
+         */
+        Clock::time_point deadline;
+#ifndef YATQ_DISABLE_FUTURES
+        /**
+         * future object. use it to obtain job result
+         */
+        Future result;
+#endif
+    } TimerHandle;
+
+private:
+#ifndef YATQ_DISABLE_FUTURES
+    using Slot = CompletionSlot<result_type>;
+#endif
+    using Mutex = Sync::mutex;
+    using ConditionVariable = Sync::condition_variable;
+
+    typedef struct {
+        Executable job;
+#ifndef YATQ_DISABLE_FUTURES
+        Slot slot;
+#endif
+    } MapEntry;
+
+    typedef struct {
+        uid_t uid;
+        Clock::time_point deadline;
+    } HeapEntry;
+
+    std::atomic<bool> _running;
+    bool _has_leader;
+    std::atomic<uid_t> _next_uid;
+    mutable Mutex _lock;
+    ConditionVariable _leader_cond;  // NB: leader waits for the first timer
+    ConditionVariable _follower_cond;  // NB: followers wait for leadership
+    std::unordered_map<uid_t, MapEntry> _jobs;
+    std::vector<HeapEntry> _heap;
+    std::vector<std::thread> _pool;
+#ifndef YATQ_DISABLE_FUTURES
+    CompletionPool<result_type, Sync> _completions;
+#endif
+
+public:
+    /**
+     * create scheduled thread pool
+     */
+    ScheduledThreadPool(): _running(false), _has_leader(false), _next_uid(0) {}
+
+    /**
+     * start pool threads with default scheduling parameters
+     * @param num_threads number of threads
+     */
+    void start(std::size_t num_threads) {
+        if (!_running) {
+            _running = true;
+            for (std::size_t i = 0; i < num_threads; ++i) {
+                std::string thread_tag = std::format("scheduled thread #{}", i);
+                auto thread = std::thread(&ScheduledThreadPool::thread_routine, this, std::move(thread_tag));
+                _pool.push_back(std::move(thread));
+            }
+        }
+    }
+
+#ifndef YATQ_DISABLE_PTHREAD
+    /**
+     * start pool threads with specified scheduling policy and priority
+     * @param num_threads number of threads
+     * @param sched_policy \a SCHED_OTHER | \a SCHED_RR | \a SCHED_FIFO
+     * @param priority \a yatq::utils::max_priority | \a yatq::utils::min_priority
+     */
+    void start(std::size_t num_threads, int sched_policy, utils::priority_t priority = utils::max_priority) {
+        start(num_threads);
+        for (auto&& thread: _pool) {
+            utils::set_sched_params(thread.native_handle(), sched_policy, priority, "scheduled_thread_pool");
+        }
+    }
+#endif
+
+    /**
+     * stop and join all the threads
+     */
+    void stop() {
+        if (_running) {
+            {
+                std::lock_guard<Mutex> guard(_lock);
+                _running = false;
+            }
+            _leader_cond.notify_all();
+            _follower_cond.notify_all();
+            for (auto&& thread: _pool) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+            _pool.clear();
+        }
+    }
+
+    /**
+     * add timed job to the queue
+     * @param deadline scheduled execution timepoint
+     * @param job job to execute
+     * @return timer handle to obtain result or cancel
+     */
+    TimerHandle enqueue(const Clock::time_point& deadline, Executable job) {
+#ifndef YATQ_DISABLE_FUTURES
+        auto [slot, future] = _completions.make();
+        auto uid = insert(deadline, {std::move(job), std::move(slot)});
+        return {uid, deadline, std::move(future)};
+#else
+        auto uid = insert(deadline, {std::move(job)});
+        return {uid, deadline};
+#endif
+    }
+
+#ifndef YATQ_DISABLE_FUTURES
+    /**
+     * add timed job to the queue and deliver its result to a callback
+     * @param deadline scheduled execution timepoint
+     * @param job job to execute
+     * @param on_complete callback; \a void(Future). called in the thread executing the job (or canceling the timer)
+     * with a ready future: use \a get() to obtain job result or exception
+     * @return timer uid
+     */
+    uid_t enqueue(const Clock::time_point& deadline, Executable job, Callback on_complete) {
+        auto [slot, future] = _completions.make();
+        future.then(std::move(on_complete));
+        return insert(deadline, {std::move(job), std::move(slot)});
+    }
+#endif
+
+    /**
+     * add timed job to the queue discarding its result. no promise is allocated
+     * @param deadline scheduled execution timepoint
+     * @param job job to execute
+     * @return timer uid
+     */
+    uid_t enqueue_detached(const Clock::time_point& deadline, Executable job) {
+        return insert(deadline, {std::move(job)});
+    }
+
+    /**
+     * cancel timed job
+     * @param uid timer uid
+     * @return \a true if timer was present in the queue; \a false otherwise
+     */
+    bool cancel(uid_t uid) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.scheduled_thread_pool");
+#endif
+
+        bool was_removed;
+        bool was_first;
+        typename decltype(_jobs)::node_type node;  // NB: destroyed (and thus result slot released) outside the lock
+        {
+            std::lock_guard<Mutex> guard(_lock);
+            auto i = _jobs.find(uid);
+            if (i != _jobs.end()) {
+                LOG4CXX_DEBUG(logger, std::format("Canceling timer uid={}", uid));
+                node = _jobs.extract(i);
+                was_removed = true;
+                was_first = (_heap[0].uid == uid);
+            }
+            else {
+                was_removed = false;
+            }
+        }
+        if (was_removed && was_first) {
+            _leader_cond.notify_one();
+        }
+        return was_removed;
+    }
+
+    /**
+     * delete all jobs from the queue
+     */
+    void clear() {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.scheduled_thread_pool");
+#endif
+
+        std::size_t total_jobs;
+        std::size_t total_timers;
+        decltype(_jobs) jobs;  // NB: destroyed (and thus result slots released) outside the lock
+        {
+            std::lock_guard<Mutex> guard(_lock);
+            total_jobs = _jobs.size();
+            _jobs.swap(jobs);
+            total_timers = _heap.size();
+            _heap.clear();
+        }
+        if (total_jobs > 0) {
+            _leader_cond.notify_one();
+        }
+        auto canceled_timers = total_timers - total_jobs;
+        LOG4CXX_DEBUG(logger, std::format("Cleared {} timers and {} canceled timers", total_jobs, canceled_timers));
+    }
+
+    /**
+     * delete all canceled timers from the queue
+     */
+    void purge() {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.scheduled_thread_pool");
+#endif
+
+        std::size_t canceled_timers;
+        {
+            std::lock_guard<Mutex> guard(_lock);
+            auto total_jobs = _jobs.size();
+            auto total_timers = _heap.size();
+            canceled_timers = total_timers - total_jobs;
+            if (total_timers > total_jobs) {
+                std::vector<HeapEntry> heap(total_jobs);
+                auto i = heap.begin();
+                for (auto&& heap_entry: _heap) {
+                    if (_jobs.contains(heap_entry.uid)) {
+                        *i++ = std::move(heap_entry);
+                    }
+                }
+                std::make_heap(heap.begin(), heap.end(), ScheduledThreadPool::heap_cmp);
+                _heap.swap(heap);
+            }
+        }
+        // NB: the leader never waits on a canceled timer => no need to notify
+        LOG4CXX_DEBUG(logger, std::format("Purged {} canceled timers", canceled_timers));
+    }
+
+    /**
+     * check whether a job is still in the queue
+     * @param uid timer uid
+     */
+    bool in_queue(uid_t uid) const {
+        std::lock_guard<Mutex> guard(_lock);
+        return _jobs.contains(uid);
+    }
+
+private:
+    uid_t insert(const Clock::time_point& deadline, MapEntry&& map_entry) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.scheduled_thread_pool");
+#endif
+
+        auto uid = _next_uid.fetch_add(1, std::memory_order_relaxed);
+        bool is_first;
+        {
+            std::lock_guard<Mutex> guard(_lock);
+            _jobs.insert(std::make_pair(uid, std::move(map_entry)));
+            _heap.push_back(HeapEntry {uid, deadline});
+            std::push_heap(_heap.begin(), _heap.end(), ScheduledThreadPool::heap_cmp);
+            is_first = (_heap[0].uid == uid);
+        }
+        if (is_first) {
+            _leader_cond.notify_one();  // NB: no leader => all threads busy; the first to finish will see the timer
+        }
+        LOG4CXX_DEBUG(logger, std::format("New timer uid={}", uid));
+        return uid;
+    }
+
+    static bool heap_cmp(const HeapEntry& lhs, const HeapEntry& rhs) {
+        return lhs.deadline > rhs.deadline;  // NB: '>'
+    }
+
+    /**
+     * wait as the leader until the first timer expires and take its job
+     * @return \a false if stopped
+     */
+    bool lead(std::unique_lock<Mutex>& guard, MapEntry& map_entry) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.scheduled_thread_pool");
+#endif
+
+        bool deadline_expired = false;
+        while (_running) {
+            if (_heap.empty()) {
+                LOG4CXX_TRACE(logger, "Wait");
+                _leader_cond.wait(guard, [this] () { return !_heap.empty() || !_running; });
+                LOG4CXX_TRACE(logger, "Wake-up");
+                continue;
+            }
+            auto current_uid = _heap[0].uid;
+            auto i = _jobs.find(current_uid);
+            if (i == _jobs.end()) {
+                LOG4CXX_DEBUG(logger, std::format("Timer uid={} has been canceled", current_uid));
+                std::pop_heap(_heap.begin(), _heap.end(), ScheduledThreadPool::heap_cmp);
+                _heap.pop_back();
+                deadline_expired = false;
+                continue;
+            }
+            if (!deadline_expired) {
+                auto now = Clock::now();  // NB: system call => context switch
+                deadline_expired = (_heap[0].deadline <= now);
+            }
+            if (deadline_expired) {
+                LOG4CXX_DEBUG(logger, std::format("Executing timer uid={}", current_uid));
+                auto node = _jobs.extract(i);
+                std::pop_heap(_heap.begin(), _heap.end(), ScheduledThreadPool::heap_cmp);
+                _heap.pop_back();
+                map_entry = std::move(node.mapped());
+                return true;
+            }
+            // NB: without this explicit cast duration type may be deduced incorrectly
+            std::chrono::time_point<Clock, typename Clock::duration> deadline = _heap[0].deadline;
+            bool notified = _leader_cond.wait_until(
+                    guard,
+                    deadline,
+                    [this, current_uid] () {
+                        return !_jobs.contains(current_uid) || (_heap[0].uid != current_uid) || !_running;
+                    }
+            );
+            deadline_expired = !notified;
+        }
+        return false;
+    }
+
+    void thread_routine(std::string&& thread_tag) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.scheduled_thread_pool");
+#endif
+
+        SET_THREAD_TAG(thread_tag);
+        LOG4CXX_INFO(logger, "Start");
+
+        std::unique_lock<Mutex> guard(_lock);
+        while (_running) {
+            if (_has_leader) {
+                _follower_cond.wait(guard, [this] () { return !_has_leader || !_running; });
+                continue;
+            }
+            _has_leader = true;
+            MapEntry map_entry;
+            auto has_job = lead(guard, map_entry);
+            _has_leader = false;
+            if (!has_job) {
+                break;
+            }
+            guard.unlock();
+            _follower_cond.notify_one();  // NB: promote a follower before running the job
+            run(std::move(map_entry));
+            guard.lock();
+        }
+
+        LOG4CXX_INFO(logger, "Stop");
+    }
+
+    // NB: by value => job destroyed before the lock is taken again
+    static void run(MapEntry map_entry) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.scheduled_thread_pool");
+#endif
+
+        LOG4CXX_TRACE(logger, "Start job");
+#ifndef YATQ_DISABLE_FUTURES
+        if (map_entry.slot) {
+            internal::run_and_complete<result_type>(map_entry.job, map_entry.slot);
+        }
+        else {
+            run_detached(map_entry.job);
+        }
+#else
+        run_detached(map_entry.job);
+#endif
+        LOG4CXX_TRACE(logger, "Job complete");
+    }
+
+    static void run_detached(Executable& job) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.scheduled_thread_pool");
+#endif
+
+        try {
+            job();
+        }
+        catch (const std::exception& exc) {
+            LOG4CXX_WARN(logger, std::format("Detached job failed: {}", exc.what()));
+        }
+        catch (...) {
+            LOG4CXX_WARN(logger, "Detached job failed");
+        }
+    }
+};
+
+}
+
+#endif
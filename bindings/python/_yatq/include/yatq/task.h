@@ -0,0 +1,282 @@
+#ifndef _YATQ_TASK_H
+#define _YATQ_TASK_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace yatq {
+
+template<typename T = void>
+class Task;
+
+namespace internal {
+
+class TaskPromiseBase {
+private:
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            auto continuation = handle.promise()._continuation;
+            return continuation ? continuation : std::noop_coroutine();  // NB: symmetric transfer
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::coroutine_handle<> _continuation;
+
+    template<typename T>
+    friend class yatq::Task;
+
+protected:
+    std::exception_ptr _exception;
+
+public:
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        _exception = std::current_exception();
+    }
+};
+
+template<typename T>
+class TaskPromise: public TaskPromiseBase {
+private:
+    std::optional<T> _value;
+
+public:
+    Task<T> get_return_object() noexcept;
+
+    template<typename U>
+    void return_value(U&& value) {
+        _value.emplace(std::forward<U>(value));
+    }
+
+    T result() {
+        if (_exception) {
+            std::rethrow_exception(_exception);
+        }
+        return std::move(*_value);
+    }
+};
+
+template<>
+class TaskPromise<void>: public TaskPromiseBase {
+public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void result() const {
+        if (_exception) {
+            std::rethrow_exception(_exception);
+        }
+    }
+};
+
+}
+
+/**
+ * lazily started coroutine: the body runs once the task is awaited and the awaiting coroutine is resumed (through
+ * symmetric transfer, i.e. without stack growth) in the thread completing the task
+ * @tparam T return type
+ */
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = internal::TaskPromise<T>;
+    using result_type = T;
+
+private:
+    std::coroutine_handle<promise_type> _handle;
+
+    friend class internal::TaskPromise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept: _handle(handle) {}
+
+    struct Awaiter {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() const noexcept {
+            return !handle || handle.done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+            handle.promise()._continuation = continuation;
+            return handle;
+        }
+
+        T await_resume() {
+            return handle.promise().result();
+        }
+    };
+
+public:
+    Task() noexcept: _handle(nullptr) {}
+
+    Task(Task&& other) noexcept: _handle(std::exchange(other._handle, nullptr)) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        reset();
+    }
+
+    /**
+     * check whether the task refers to a coroutine
+     */
+    bool valid() const noexcept {
+        return static_cast<bool>(_handle);
+    }
+
+    /**
+     * check whether the coroutine has completed
+     */
+    bool is_ready() const noexcept {
+        return _handle && _handle.done();
+    }
+
+    Awaiter operator co_await() const & noexcept {
+        return Awaiter {_handle};
+    }
+
+    Awaiter operator co_await() const && noexcept {
+        return Awaiter {_handle};
+    }
+
+private:
+    void reset() noexcept {
+        if (_handle) {
+            std::exchange(_handle, nullptr).destroy();
+        }
+    }
+};
+
+namespace internal {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// NB: lives in the waiting thread rather than in the coroutine frame, which the waiter destroys once 'done' is set
+typedef struct {
+    std::mutex lock;
+    std::condition_variable cond;
+    bool done = false;
+} SyncWaitState;
+
+struct SyncWaitCoroutine {
+    struct promise_type {
+        SyncWaitState* state = nullptr;
+
+        SyncWaitCoroutine get_return_object() noexcept {
+            return SyncWaitCoroutine {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        auto final_suspend() noexcept {
+            struct Notifier {
+                bool await_ready() const noexcept {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept {
+                    auto state = handle.promise().state;  // NB: the frame may be gone once 'done' is set
+                    std::lock_guard<std::mutex> guard(state->lock);
+                    state->done = true;
+                    state->cond.notify_one();  // NB: under the lock => the waiter cannot destroy 'state' meanwhile
+                }
+
+                void await_resume() const noexcept {}
+            };
+            return Notifier {};
+        }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept {
+            std::terminate();  // NB: 'sync_wait()' catches everything
+        }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+}
+
+/**
+ * run task and block the calling thread until it completes
+ * @param task task to run
+ * @return task return value
+ * @throw task exception
+ */
+template<typename T>
+T sync_wait(Task<T>&& task) {
+    std::exception_ptr exception;
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+    auto body = [] (Task<T>& task, auto& value, std::exception_ptr& exception) -> internal::SyncWaitCoroutine {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+                value.emplace(true);
+            }
+            else {
+                value.emplace(co_await task);
+            }
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+    };
+    internal::SyncWaitState state;
+    auto coroutine = body(task, value, exception);
+    coroutine.handle.promise().state = &state;
+    coroutine.handle.resume();
+    {
+        std::unique_lock<std::mutex> guard(state.lock);
+        state.cond.wait(guard, [&state] () { return state.done; });
+    }
+    coroutine.handle.destroy();
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*value);
+    }
+}
+
+}
+
+#endif
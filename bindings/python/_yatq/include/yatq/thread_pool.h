@@ -1,63 +1,214 @@
 #ifndef _YATQ_THREAD_POOL_H
 #define _YATQ_THREAD_POOL_H
 
-#include <condition_variable>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
 #include <deque>
+#include <exception>
 #include <format>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
 
-#ifndef YATQ_DISABLE_FUTURES
-#define BOOST_THREAD_PROVIDES_FUTURE
-#define BOOST_THREAD_PROVIDES_FUTURE_CONTINUATION
-#include <boost/thread/future.hpp>
-#endif
-
 #include "yatq/internal/concepts.h"
+#include "yatq/internal/log4cxx_proxy.h"
+#include "yatq/internal/spin_utils.h"
+#include "yatq/utils/histogram.h"
+#include "yatq/utils/queue_utils.h"
+#include "yatq/utils/sync_utils.h"
+#ifndef YATQ_DISABLE_PTHREAD
+#include "yatq/utils/sched_utils.h"
+#endif
 #ifndef YATQ_DISABLE_FUTURES
-#include "yatq/internal/promise_utils.h"
+#include "yatq/completion.h"
 #endif
-#include "yatq/internal/log4cxx_proxy.h"
+#include "yatq/move_only_function.h"
 
 namespace yatq {
 
 using internal::ExecutableGeneric;
+using internal::QueueGeneric;
+using internal::SyncGeneric;
+
+/**
+ * elastic thread pool resize reason
+ */
+typedef enum {grow_on_queue_depth, grow_on_job_age, retire_on_keep_alive} resize_reason_t;
+
+typedef struct {
+    resize_reason_t reason;
+    /**
+     * number of threads after resize
+     */
+    std::size_t num_threads;
+} ResizeEvent;
+
+/**
+ * elastic thread pool sizing. see \a ThreadPool::start(ElasticOptions)
+ */
+typedef struct {
+    std::size_t min_threads;
+    std::size_t max_threads;
+    /**
+     * add a thread when more jobs than that are pending and no thread is idle
+     */
+    std::size_t max_queue_depth = 8;
+    /**
+     * add a thread when a job has waited in the queue longer than that. measured when the job is taken
+     */
+    std::chrono::steady_clock::duration max_job_age = std::chrono::milliseconds(1);
+    /**
+     * retire a thread (down to \a min_threads) idle for that long
+     */
+    std::chrono::steady_clock::duration keep_alive = std::chrono::seconds(10);
+    /**
+     * optional resize observer. called in the thread adding (the pool manager thread or a pool thread) or retiring a
+     * thread; calls may be concurrent
+     */
+    MoveOnlyFunction<void(const ResizeEvent&)> on_resize;
+} ElasticOptions;
+
+/**
+ * what a submission to a full thread pool queue does. see \a ThreadPool::set_overflow_policy()
+ */
+typedef enum {block_when_full, reject_when_full, drop_oldest_when_full} overflow_policy_t;
+
+/**
+ * \a ThreadPool::try_execute() outcome
+ */
+typedef enum {submit_accepted, submit_rejected} submit_status_t;
 
-template<ExecutableGeneric _Executable = std::function<void(void)>>
+typedef struct {
+    /**
+     * submissions refused because the queue was full
+     */
+    std::size_t rejected;
+    /**
+     * submissions that found the queue full and waited for room
+     */
+    std::size_t blocked;
+    /**
+     * queued jobs evicted to make room
+     */
+    std::size_t dropped;
+} OverflowStats;
+
+/**
+ * thread pool worker statistics, see \a ThreadPool::stats(). times in nanoseconds
+ */
+typedef struct {
+    std::uint64_t jobs;  // NB: jobs and coroutine resumptions run
+    std::uint64_t busy_time;
+    std::uint64_t idle_time;
+} WorkerStats;
+
+/**
+ * thread pool statistics, see \a ThreadPool::stats(). times in nanoseconds
+ */
+typedef struct {
+    std::size_t queue_depth;
+    std::uint64_t oldest_job_age;  // NB: age of the job at the head of the queue
+    utils::HistogramSummary wait_time;  // NB: from submission to start
+    utils::HistogramSummary service_time;  // NB: from start to finish
+    std::vector<WorkerStats> workers;  // NB: current workers; retired ones only count in the histograms
+} ThreadPoolStats;
+
+template<
+    ExecutableGeneric _Executable = MoveOnlyFunction<void(void)>,
+    SyncGeneric _Sync = utils::StdSync,
+    QueueGeneric<_Sync> _Queue = utils::LockedQueue
+>
 class ThreadPool {
 public:
     using Executable = _Executable;
-    using result_type = Executable::result_type;
+    using Sync = _Sync;
+    using Queue = _Queue;
+    using result_type = internal::executable_result_t<Executable>;
 #ifndef YATQ_DISABLE_FUTURES
-    using Future = boost::future<result_type>;
+    using Future = CompletionHandle<result_type>;
+    using Slot = CompletionSlot<result_type>;
 #endif
 
 private:
-#ifndef YATQ_DISABLE_FUTURES
-    using Promise = boost::promise<result_type>;
-#endif
-
     typedef struct {
         Executable job;
 #ifndef YATQ_DISABLE_FUTURES
-        Promise promise;
+        Slot slot;
 #endif
+        std::coroutine_handle<> coroutine;  // NB: set for coroutines to resume only
+        std::chrono::steady_clock::time_point deadline;  // NB: set for jobs with a deadline only
+        bool staged;
+        std::chrono::steady_clock::time_point enqueued;  // NB: set in elastic mode or with statistics enabled only
     } QueueEntry;
 
-    bool _running;
-    std::mutex _lock;
-    std::condition_variable _cond;
-    std::deque<QueueEntry> _queue;
+    // NB: written by its worker only, read by 'stats()'
+    struct alignas(64) WorkerCounters {
+        std::atomic<std::uint64_t> jobs {0};
+        std::atomic<std::uint64_t> busy_time {0};
+        std::atomic<std::uint64_t> idle_time {0};
+        std::atomic<std::int64_t> since {0};  // NB: nanoseconds since the clock epoch of the last busy/idle switch; 0 => unknown
+        std::atomic<bool> busy {false};
+        utils::Histogram wait_time;
+        utils::Histogram service_time;
+    };
+
+    // NB: coroutines resumed from a worker thread stay on that worker
+    typedef struct {
+        ThreadPool* pool;
+        std::deque<std::coroutine_handle<>> ready;
+        std::size_t streak;  // consecutive local resumptions
+        WorkerCounters* counters;
+    } Worker;
+
+    // NB: applied by a worker thread to itself before taking any job
+    using Setup = MoveOnlyFunction<void(const std::string&)>;
+    using Mutex = Sync::mutex;
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    static constexpr std::size_t max_local_streak = 64;  // NB: then give jobs from the shared queue a chance
+
+    inline static thread_local Worker* _current_worker = nullptr;
+
+    std::atomic<bool> _running;
+    std::atomic<std::size_t> _spinners;
+    std::atomic<std::size_t> _max_spinners;
+    Queue::template queue<QueueEntry, Sync> _queue;
+    Mutex _pool_lock;  // NB: guards '_pool', '_retired' and '_counters' against elastic resizing and 'stats()'
     std::vector<std::thread> _pool;
+    std::vector<std::unique_ptr<WorkerCounters>> _counters;  // NB: one per '_pool' thread, same order
+    std::vector<std::thread::id> _retired;  // NB: exiting threads to join
+    std::atomic<std::size_t> _num_threads;
+    bool _elastic;
+    ElasticOptions _elastic_options;
+    std::atomic<std::size_t> _pending;  // NB: elastic mode only
+    std::atomic<std::size_t> _idle;  // NB: elastic mode only
+    std::thread _manager;  // NB: elastic mode only; adds threads on behalf of producers
+    std::atomic<bool> _grow_requested;
+    std::atomic<overflow_policy_t> _overflow_policy;
+    std::atomic<std::size_t> _rejected;
+    std::atomic<std::size_t> _blocked;
+    std::atomic<std::size_t> _dropped;
+    std::atomic<bool> _stats;
+    utils::Histogram _retired_wait_time;  // NB: guarded by '_pool_lock'
+    utils::Histogram _retired_service_time;  // NB: guarded by '_pool_lock'
+#ifndef YATQ_DISABLE_FUTURES
+    CompletionPool<result_type, Sync> _completions;
+#endif
 
 public:
     /**
      * create thread pool
      */
-    ThreadPool(): _running(false) {}
+    ThreadPool(): _running(false), _spinners(0), _max_spinners(1), _num_threads(0), _elastic(false), _elastic_options(), _pending(0), _idle(0), _grow_requested(false),
+        _overflow_policy(block_when_full), _rejected(0), _blocked(0), _dropped(0), _stats(false) {}
 
     /**
      * start thread pool
@@ -66,30 +217,152 @@ public:
     void start(std::size_t num_threads) {
         if (!_running) {
             _running = true;
+            _elastic = false;
+            std::lock_guard<Mutex> guard(_pool_lock);
             for (int i = 0; i < num_threads; ++i) {
-                std::string thread_tag = std::format("pool thread #{}", i);
-                auto thread = std::thread(&ThreadPool::thread_routine, this, std::move(thread_tag));
-                _pool.push_back(std::move(thread));
+                spawn(Setup());
             }
         }
     }
 
+    /**
+     * start elastic thread pool: it starts with \a min_threads, adds a thread (up to \a max_threads) whenever the queue
+     * backs up or jobs wait too long, and retires threads idle for longer than keep-alive. a producer backing the queue
+     * up never creates the thread itself (it may be the timer queue thread): it asks a manager thread to. requires a
+     * queue policy with timed \a pop() (e.g. the default \a yatq::utils::LockedQueue)
+     * @param options sizing options
+     */
+    void start(ElasticOptions options) requires internal::TimedQueueGeneric<Queue, Sync> {
+        if (!_running) {
+            _running = true;
+            _elastic = true;
+            _elastic_options = std::move(options);
+            _pending = 0;
+            _grow_requested = false;
+            std::lock_guard<Mutex> guard(_pool_lock);
+            for (std::size_t i = 0; i < _elastic_options.min_threads; ++i) {
+                spawn(Setup());
+            }
+            _manager = std::thread(&ThreadPool::manage, this);
+        }
+    }
+
+#ifndef YATQ_DISABLE_PTHREAD
+    /**
+     * start thread pool with specified scheduling policy and priority
+     * @param num_threads number of threads
+     * @param sched_policy \a SCHED_OTHER | \a SCHED_RR | \a SCHED_FIFO
+     * @param priority \a yatq::utils::max_priority | \a yatq::utils::min_priority
+     */
+    void start(std::size_t num_threads, int sched_policy, utils::priority_t priority = utils::max_priority) {
+        start(num_threads, sched_policy, utils::get_priority(sched_policy, priority));
+    }
+
+    /**
+     * start thread pool with specified scheduling policy and priority
+     * @param num_threads number of threads
+     * @param sched_policy \a SCHED_OTHER | \a SCHED_RR | \a SCHED_FIFO
+     * @param priority explicit priority
+     */
+    void start(std::size_t num_threads, int sched_policy, int priority) {
+        start({utils::ThreadGroup {num_threads}}, sched_policy, priority);
+    }
+
+    /**
+     * start thread pool made of thread groups, each restricted to its own CPU set and/or NUMA node. e.g. a group per
+     * CPU with one thread each pins every thread to a CPU
+     * @param groups thread groups
+     */
+    void start(const std::vector<utils::ThreadGroup>& groups) {
+        if (!_running) {
+            _running = true;
+            _elastic = false;
+            std::lock_guard<Mutex> guard(_pool_lock);
+            for (auto&& group: groups) {
+                for (std::size_t i = 0; i < group.num_threads; ++i) {
+                    spawn(placement(group));
+                }
+            }
+        }
+    }
+
+    /**
+     * start thread pool made of thread groups with specified scheduling policy and priority
+     * @param groups thread groups
+     * @param sched_policy \a SCHED_OTHER | \a SCHED_RR | \a SCHED_FIFO
+     * @param priority \a yatq::utils::max_priority | \a yatq::utils::min_priority
+     */
+    void start(const std::vector<utils::ThreadGroup>& groups, int sched_policy, utils::priority_t priority = utils::max_priority) {
+        start(groups, sched_policy, utils::get_priority(sched_policy, priority));
+    }
+
+    /**
+     * start thread pool made of thread groups with specified scheduling policy and priority
+     * @param groups thread groups
+     * @param sched_policy \a SCHED_OTHER | \a SCHED_RR | \a SCHED_FIFO
+     * @param priority explicit priority
+     */
+    void start(const std::vector<utils::ThreadGroup>& groups, int sched_policy, int priority) {
+        if (!_running) {
+            _running = true;
+            _elastic = false;
+            std::lock_guard<Mutex> guard(_pool_lock);
+            for (auto&& group: groups) {
+                for (std::size_t i = 0; i < group.num_threads; ++i) {
+                    spawn(
+                        [place = placement(group), sched_policy, priority]
+                        (const std::string& thread_tag) mutable {
+                            place(thread_tag);
+                            utils::set_sched_params(pthread_self(), sched_policy, priority, thread_tag);
+                        }
+                    );
+                }
+            }
+        }
+    }
+#endif
+
     /**
      * stop thread pool and join all the threads
      */
     void stop() {
         if (_running) {
             _running = false;
-            _cond.notify_all();
-            for (auto&& thread: _pool) {
+            _queue.wake_all();
+            if (_manager.joinable()) {
+                _grow_requested = true;
+                _grow_requested.notify_one();
+                _manager.join();
+            }
+            decltype(_pool) pool;
+            {
+                std::lock_guard<Mutex> guard(_pool_lock);
+                pool.swap(_pool);
+                _retired.clear();
+            }
+            for (auto&& thread: pool) {
                 if (thread.joinable()) {
                     thread.join();
                 }
             }
-            _pool.clear();
+            {
+                std::lock_guard<Mutex> guard(_pool_lock);
+                for (auto&& counters: _counters) {
+                    retire_counters(*counters);
+                }
+                _counters.clear();
+            }
+            _num_threads = 0;
         }
     }
 
+    /**
+     * @return current number of threads. varies in elastic mode
+     */
+    std::size_t num_threads() const noexcept {
+        return _num_threads.load(std::memory_order_relaxed);
+    }
+
     /**
      * execute job in a thread
      * @param job job to execute
@@ -102,26 +375,537 @@ public:
 #endif
     execute(Executable job) {
 #ifndef YATQ_DISABLE_FUTURES
-        Promise promise;
-        auto future = promise.get_future();
+        auto [slot, future] = _completions.make();
+        push(std::move(job), std::move(slot));
+        return std::move(future);
+#else
+        push(std::move(job));
 #endif
-        {
-            std::lock_guard<std::mutex> guard(_lock);
-            _queue.push_back({
-                std::move(job)
+    }
+
+    /**
+     * execute job in a thread discarding its result. no promise is allocated
+     * @param job job to execute
+     */
+    void execute_detached(Executable job) {
+        push(std::move(job));
+    }
+
 #ifndef YATQ_DISABLE_FUTURES
-                , std::move(promise)
+    /**
+     * execute job in a thread and store its result straight into the given slot
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     */
+    void execute(Executable job, Slot slot) {
+        push(std::move(job), std::move(slot));
+    }
 #endif
-            });
+
+    /**
+     * execute job in a thread unless the queue is full. never blocks: under \a block_when_full the job is rejected
+     * instead (see \a set_overflow_policy())
+     * @param job job to execute
+     * @return future object or \a std::nullopt if rejected
+     */
+#ifndef YATQ_DISABLE_FUTURES
+    std::optional<Future> try_execute(Executable job) {
+        auto [slot, future] = _completions.make();
+        if (submit(false, std::move(job), std::move(slot)) == submit_rejected) {
+            return std::nullopt;
         }
-        _cond.notify_one();
+        return std::move(future);
+    }
+#else
+    submit_status_t try_execute(Executable job) {
+        return submit(false, std::move(job));
+    }
+#endif
+
+    /**
+     * execute job in a thread unless the queue is full discarding its result. never blocks
+     * @param job job to execute
+     * @return \a submit_rejected if the queue is full
+     */
+    submit_status_t try_execute_detached(Executable job) {
+        return submit(false, std::move(job));
+    }
+
 #ifndef YATQ_DISABLE_FUTURES
+    /**
+     * execute job in a thread unless the queue is full and store its result straight into the given slot. never
+     * blocks; a rejected job fails the slot with \a std::runtime_error
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     * @return \a submit_rejected if the queue is full
+     */
+    submit_status_t try_execute(Executable job, Slot slot) {
+        return submit(false, std::move(job), std::move(slot));
+    }
+#endif
+
+    /**
+     * execute job in a thread ordering it by deadline among pending jobs. available with a deadline ordered queue
+     * policy (see \a yatq::utils::DeadlineQueue); jobs submitted without a deadline are due at submission. never blocks
+     * on a full queue, like \a try_execute()
+     * @param job job to execute
+     * @param deadline job deadline; may be in the past
+     * @return future object. use it to obtain job result
+     */
+#ifndef YATQ_DISABLE_FUTURES
+    Future
+#else
+    void
+#endif
+    execute(Executable job, const std::chrono::steady_clock::time_point& deadline)
+    requires internal::DeadlineQueueGeneric<Queue> {
+#ifndef YATQ_DISABLE_FUTURES
+        auto [slot, future] = _completions.make();
+        submit(false, std::move(job), std::move(slot), std::coroutine_handle<>(), deadline);
         return std::move(future);
+#else
+        submit(false, std::move(job), std::coroutine_handle<>(), deadline);
+#endif
+    }
+
+#ifndef YATQ_DISABLE_FUTURES
+    /**
+     * execute job in a thread ordering it by deadline and store its result straight into the given slot. see
+     * \a execute(Executable, const std::chrono::steady_clock::time_point&)
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     * @param deadline job deadline; may be in the past
+     */
+    void execute(Executable job, Slot slot, const std::chrono::steady_clock::time_point& deadline)
+    requires internal::DeadlineQueueGeneric<Queue> {
+        submit(false, std::move(job), std::move(slot), std::coroutine_handle<>(), deadline);
+    }
+#endif
+
+    /**
+     * hand a job over ahead of its deadline: the worker picking it up busy-waits until the deadline and then runs it,
+     * so the job start doesn't depend on a thread wake-up. used by \a TimerQueue for timers enqueued with
+     * \a TimerOptions::stage. a worker beyond \a set_max_spinners() sleeps until the deadline instead. never blocks on
+     * a full queue, like \a try_execute()
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     * @param deadline job start timepoint
+     */
+#ifndef YATQ_DISABLE_FUTURES
+    void stage(Executable job, Slot slot, const std::chrono::steady_clock::time_point& deadline) {
+        submit(false, std::move(job), std::move(slot), std::coroutine_handle<>(), deadline, true);
+    }
+#else
+    void stage(Executable job, const std::chrono::steady_clock::time_point& deadline) {
+        submit(false, std::move(job), std::coroutine_handle<>(), deadline, true);
+    }
+#endif
+
+    /**
+     * limit the number of workers busy-waiting for staged jobs at a time. see \a stage()
+     * @param max_spinners max number of spinning workers; 1 by default
+     */
+    void set_max_spinners(std::size_t max_spinners) {
+        _max_spinners.store(max_spinners, std::memory_order_relaxed);
+    }
+
+    /**
+     * set how idle workers wait for jobs: spin, then yield, then park (see \a yatq::utils::IdleStrategy). a spinning
+     * worker picks a job up without a wake-up system call. available with queue policies supporting it (e.g. the default
+     * \a yatq::utils::LockedQueue); workers park right away by default
+     * @param idle_strategy idle strategy
+     */
+    void set_idle_strategy(const utils::IdleStrategy& idle_strategy)
+    requires requires (Queue::template queue<QueueEntry, Sync>& queue) { queue.set_idle_strategy(idle_strategy); } {
+        _queue.set_idle_strategy(idle_strategy);
+    }
+
+    /**
+     * bound the job queue. available with queue policies supporting it (e.g. the default \a yatq::utils::LockedQueue);
+     * see \a set_overflow_policy() for what a submission to a full queue does
+     * @param capacity max number of queued jobs; 0 => unbounded (default)
+     */
+    void set_capacity(std::size_t capacity)
+    requires requires (Queue::template queue<QueueEntry, Sync>& queue) { queue.set_capacity(capacity); } {
+        _queue.set_capacity(capacity);
+    }
+
+    /**
+     * set what a submission to a full queue does: block the producer (default), reject the job or evict the job at
+     * the head of the queue. rejected and evicted jobs fail with \a std::runtime_error. coroutine resumptions are exempt:
+     * they are always queued, possibly beyond the capacity, and never evicted. \a try_execute(), \a stage() and deadline submissions never block: they reject under
+     * \a block_when_full. a pool thread submitting to its own full pool runs the job in place instead of blocking
+     * @param policy \a block_when_full | \a reject_when_full | \a drop_oldest_when_full
+     */
+    void set_overflow_policy(overflow_policy_t policy) {
+        _overflow_policy.store(policy, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return rejected, blocked and dropped submission counts so far
+     */
+    OverflowStats overflow_stats() const noexcept {
+        return {
+            _rejected.load(std::memory_order_relaxed),
+            _blocked.load(std::memory_order_relaxed),
+            _dropped.load(std::memory_order_relaxed)
+        };
+    }
+
+    /**
+     * turn statistics recording on or off; off by default. on, it costs a clock read per submission and two per job,
+     * recorded by each worker into its own counters and histograms. see \a stats()
+     * @param enabled whether to record statistics
+     */
+    void set_stats_enabled(bool enabled) {
+        _stats.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return queue depth, age of the job at the head of the queue, wait time and service time histograms of the jobs
+     * (since start or since the previous \a stop()) and busy and idle times of each worker. the queue depth is reported
+     * by queue policies supporting it (all the ones in \a yatq::utils) and the head job age by the ones able to peek
+     * at the oldest job (e.g. the default \a yatq::utils::LockedQueue); 0 otherwise. see \a set_stats_enabled()
+     */
+    ThreadPoolStats stats() {
+        ThreadPoolStats stats {};
+        if constexpr (requires (Queue::template queue<QueueEntry, Sync>& queue) { { queue.size() } -> std::convertible_to<std::size_t>; }) {
+            stats.queue_depth = _queue.size();
+        }
+        auto now = std::chrono::steady_clock::now();
+        if constexpr (requires (Queue::template queue<QueueEntry, Sync>& queue) { queue.peek([] (const QueueEntry&) {}); }) {
+            _queue.peek(
+                [&stats, &now] (const QueueEntry& queue_entry) {
+                    if (queue_entry.enqueued != TimePoint()) {
+                        stats.oldest_job_age = nanoseconds(now - queue_entry.enqueued);
+                    }
+                }
+            );
+        }
+        utils::Histogram wait_time;
+        utils::Histogram service_time;
+        std::lock_guard<Mutex> guard(_pool_lock);
+        wait_time.merge(_retired_wait_time);
+        service_time.merge(_retired_service_time);
+        auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        stats.workers.reserve(_counters.size());
+        for (auto&& counters: _counters) {
+            wait_time.merge(counters->wait_time);
+            service_time.merge(counters->service_time);
+            WorkerStats worker {
+                counters->jobs.load(std::memory_order_relaxed),
+                counters->busy_time.load(std::memory_order_relaxed),
+                counters->idle_time.load(std::memory_order_relaxed)
+            };
+            // NB: add the ongoing busy or idle period; 'busy' and 'since' are read apart => approximate
+            auto since = counters->since.load(std::memory_order_relaxed);
+            if (since != 0 && now_ns > since) {
+                (counters->busy.load(std::memory_order_relaxed) ? worker.busy_time : worker.idle_time) += now_ns - since;
+            }
+            stats.workers.push_back(worker);
+        }
+        stats.wait_time = wait_time.summary();
+        stats.service_time = service_time.summary();
+        return stats;
+    }
+
+    /**
+     * awaitable moving the awaiting coroutine onto a pool thread. see \a schedule()
+     */
+    class ScheduleAwaitable {
+    private:
+        ThreadPool* const _pool;
+
+        friend class ThreadPool;
+
+        explicit ScheduleAwaitable(ThreadPool* pool) noexcept: _pool(pool) {}
+
+    public:
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            _pool->resume(handle);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * hop onto a pool thread:  co_await thread_pool.schedule(). awaited from a pool thread, it yields to other
+     * coroutines resumed by the same thread
+     * @return awaitable
+     */
+    ScheduleAwaitable schedule() noexcept {
+        return ScheduleAwaitable(this);
+    }
+
+    /**
+     * resume suspended coroutine in a thread. called from a pool thread, resumes it later in the same thread bypassing
+     * the shared queue
+     * @param handle coroutine handle
+     */
+    void resume(std::coroutine_handle<> handle) {
+        if (_current_worker && _current_worker->pool == this) {
+            _current_worker->ready.push_back(handle);
+            return;
+        }
+#ifndef YATQ_DISABLE_FUTURES
+        push(Executable(), Slot(), handle);
+#else
+        push(Executable(), handle);
 #endif
     }
 
 private:
-    void thread_routine(std::string&& thread_tag) {
+    // NB: '_pool_lock' must be held once the pool is running
+    void spawn(Setup&& setup) {
+        std::string thread_tag = std::format("pool thread #{}", _pool.size());
+        auto& counters = _counters.emplace_back(std::make_unique<WorkerCounters>());
+        try {
+            _pool.emplace_back(&ThreadPool::thread_routine, this, std::move(thread_tag), std::move(setup), counters.get());
+        }
+        catch (...) {
+            _counters.pop_back();
+            throw;
+        }
+        _num_threads.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // NB: '_pool_lock' must be held; keeps the histograms of a thread going away
+    void retire_counters(const WorkerCounters& counters) {
+        _retired_wait_time.merge(counters.wait_time);
+        _retired_service_time.merge(counters.service_time);
+    }
+
+    // NB: '_pool_lock' must be held
+    void reap() {
+        auto self = std::this_thread::get_id();
+        std::erase_if(
+            _retired,
+            [this, self] (const std::thread::id& id) {
+                if (id == self) {
+                    return false;
+                }
+                auto i = std::ranges::find_if(_pool, [id] (const std::thread& thread) { return thread.get_id() == id; });
+                i->join();  // NB: the thread is exiting
+                auto counters = _counters.begin() + (i - _pool.begin());
+                retire_counters(**counters);
+                _counters.erase(counters);
+                _pool.erase(i);
+                return true;
+            }
+        );
+    }
+
+    // NB: 'true' => a thread has been added
+    bool grow(resize_reason_t reason) {
+        std::unique_lock<Mutex> guard(_pool_lock, std::try_to_lock);  // NB: someone is resizing already => skip
+        if (!guard.owns_lock() || !_running || _num_threads.load(std::memory_order_relaxed) >= _elastic_options.max_threads) {
+            return false;
+        }
+        reap();
+        spawn(Setup());
+        ResizeEvent event {reason, _num_threads.load(std::memory_order_relaxed)};
+        guard.unlock();
+        notify_resize(event);
+        return true;
+    }
+
+    bool backed_up() const noexcept {
+        return _pending.load(std::memory_order_relaxed) > _elastic_options.max_queue_depth && _idle.load(std::memory_order_relaxed) == 0;
+    }
+
+    // NB: leaves thread creation to the manager thread; a single pending request at a time
+    void request_grow() {
+        if (!_grow_requested.load(std::memory_order_relaxed) && !_grow_requested.exchange(true, std::memory_order_relaxed)) {
+            _grow_requested.notify_one();
+        }
+    }
+
+    void manage() {
+        SET_THREAD_TAG("pool manager");
+        for (;;) {
+            _grow_requested.wait(false, std::memory_order_relaxed);
+            _grow_requested.store(false, std::memory_order_relaxed);
+            if (!_running) {
+                break;
+            }
+            // NB: requests coalesce => keep adding threads while the queue is backed up
+            while (grow(grow_on_queue_depth) && backed_up()) {}
+        }
+    }
+
+    // NB: called by a thread on keep-alive expiry; 'true' => the thread should exit
+    bool retire() {
+        std::unique_lock<Mutex> guard(_pool_lock);
+        if (!_running || _num_threads.load(std::memory_order_relaxed) <= _elastic_options.min_threads) {
+            return false;
+        }
+        reap();
+        _retired.push_back(std::this_thread::get_id());
+        ResizeEvent event {retire_on_keep_alive, _num_threads.fetch_sub(1, std::memory_order_relaxed) - 1};
+        guard.unlock();
+        notify_resize(event);
+        return true;
+    }
+
+    void notify_resize(const ResizeEvent& event) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.thread_pool");
+#endif
+
+        LOG4CXX_DEBUG(logger, std::format("Resized to {} threads, reason={}", event.num_threads, static_cast<int>(event.reason)));
+        if (_elastic_options.on_resize) {
+            _elastic_options.on_resize(event);
+        }
+    }
+
+#ifndef YATQ_DISABLE_PTHREAD
+    static Setup placement(const utils::ThreadGroup& group) {
+        return [cpus = group.cpus, numa_node = group.numa_node] (const std::string& thread_tag) {
+            if (!cpus.empty()) {
+                utils::set_cpu_affinity(pthread_self(), cpus, thread_tag);
+            }
+            if (numa_node >= 0) {
+                utils::set_numa_node(numa_node, thread_tag);
+            }
+        };
+    }
+#endif
+
+    template<typename... Args>
+    void push(Args&&... args) {
+        submit(true, std::forward<Args>(args)...);
+    }
+
+    // NB: 'can_block' is false for submissions that must not wait for room, e.g. from the timer queue thread
+    template<typename... Args>
+    submit_status_t submit(bool can_block, Args&&... args) {
+        QueueEntry queue_entry {std::forward<Args>(args)...};
+        if constexpr (internal::DeadlineQueueGeneric<Queue>) {
+            if (queue_entry.deadline == std::chrono::steady_clock::time_point()) {
+                queue_entry.deadline = std::chrono::steady_clock::now();  // NB: no deadline => due now
+            }
+        }
+        if (_elastic || _stats.load(std::memory_order_relaxed)) {
+            queue_entry.enqueued = std::chrono::steady_clock::now();
+        }
+        if (!_elastic) {
+            return enqueue(std::move(queue_entry), can_block);
+        }
+        _pending.fetch_add(1, std::memory_order_relaxed);  // NB: before the push => no underflow
+        auto status = enqueue(std::move(queue_entry), can_block);
+        if (status == submit_rejected) {
+            _pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+        else if (backed_up()) {
+            request_grow();
+        }
+        return status;
+    }
+
+    submit_status_t enqueue(QueueEntry&& queue_entry, bool can_block) {
+        // NB: a suspended coroutine can neither be dropped nor wait for room: the timer queue thread resumes sleepers
+        // through here
+        if (queue_entry.coroutine) {
+            force(std::move(queue_entry));
+            return submit_accepted;
+        }
+        if (_queue.try_push(std::move(queue_entry))) {
+            return submit_accepted;
+        }
+        auto policy = _overflow_policy.load(std::memory_order_relaxed);
+        if (policy == drop_oldest_when_full) {
+            QueueEntry evicted;
+            do {
+                if (_queue.try_pop(evicted)) {
+                    if (evicted.coroutine) {
+                        // NB: not evictable => put it back and exceed the capacity by one
+                        force(std::move(evicted));
+                        force(std::move(queue_entry));
+                        return submit_accepted;
+                    }
+                    if (_elastic) {
+                        _pending.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
+                    overflow(evicted, "Job evicted from full thread pool queue");
+                }
+            } while (!_queue.try_push(std::move(queue_entry)));
+            return submit_accepted;
+        }
+        if (policy == block_when_full && can_block) {
+            if (_current_worker && _current_worker->pool == this) {
+                if (_elastic) {
+                    _pending.fetch_sub(1, std::memory_order_relaxed);
+                }
+                run(queue_entry);  // NB: a pool thread blocking on a full queue may deadlock the pool => run in place
+                return submit_accepted;
+            }
+            _blocked.fetch_add(1, std::memory_order_relaxed);
+            _queue.push(std::move(queue_entry));
+            return submit_accepted;
+        }
+        _rejected.fetch_add(1, std::memory_order_relaxed);
+        overflow(queue_entry, "Thread pool queue is full");
+        return submit_rejected;
+    }
+
+    // NB: enqueue regardless of the capacity; queue policies without a bypass are unbounded or block
+    void force(QueueEntry&& queue_entry) {
+        if constexpr (requires { _queue.force_push(std::move(queue_entry)); }) {
+            _queue.force_push(std::move(queue_entry));
+        }
+        else {
+            _queue.push(std::move(queue_entry));
+        }
+    }
+
+    // NB: fail a job refused or evicted by a full queue
+    static void overflow(QueueEntry& queue_entry, const char* reason) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.thread_pool");
+#endif
+
+        LOG4CXX_DEBUG(logger, reason);
+#ifndef YATQ_DISABLE_FUTURES
+        if (queue_entry.slot) {
+            queue_entry.slot.set_exception(std::make_exception_ptr(std::runtime_error(reason)));
+        }
+#endif
+    }
+
+    // NB: 'false' => the thread should exit
+    bool pop(QueueEntry& queue_entry) {
+        if constexpr (internal::TimedQueueGeneric<Queue, Sync>) {
+            if (_elastic) {
+                for (;;) {
+                    _idle.fetch_add(1, std::memory_order_relaxed);
+                    auto keep_alive = std::chrono::steady_clock::now() + _elastic_options.keep_alive;
+                    auto popped = _queue.pop(queue_entry, _running, keep_alive);
+                    _idle.fetch_sub(1, std::memory_order_relaxed);
+                    if (popped) {
+                        return true;
+                    }
+                    if (!_running || retire()) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return _queue.pop(queue_entry, _running);
+    }
+
+    void dequeued(const QueueEntry& queue_entry) {
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+        if (std::chrono::steady_clock::now() - queue_entry.enqueued > _elastic_options.max_job_age) {
+            grow(grow_on_job_age);
+        }
+    }
+
+    void thread_routine(std::string&& thread_tag, Setup&& setup, WorkerCounters* counters) {
 #ifndef YATQ_DISABLE_LOGGING
         static auto logger = log4cxx::Logger::getLogger("yatq.thread_pool");
 #endif
@@ -129,27 +913,143 @@ private:
         SET_THREAD_TAG(thread_tag);
         LOG4CXX_INFO(logger, "Start");
 
+        if (setup) {
+            setup(thread_tag);
+        }
+
+        Worker worker {this, {}, 0, counters};
+        _current_worker = &worker;
+        if (_stats.load(std::memory_order_relaxed)) {
+            counters->since.store(nanoseconds(std::chrono::steady_clock::now().time_since_epoch()), std::memory_order_relaxed);
+        }
+
         while (_running) {
+            if (!worker.ready.empty() && worker.streak < max_local_streak) {
+                ++worker.streak;
+                auto handle = worker.ready.front();
+                worker.ready.pop_front();
+                auto start = started(*counters);
+                handle.resume();
+                finished(*counters, start);
+                continue;
+            }
+            worker.streak = 0;
+
             QueueEntry queue_entry;
-            {
-                std::unique_lock<std::mutex> guard(_lock);
-                _cond.wait(guard, [this] () { return !_queue.empty() || !_running; });
-                if (!_running) {
-                    break;
+            if (!worker.ready.empty()) {
+                if (!_queue.try_pop(queue_entry)) {
+                    continue;  // NB: local coroutines only
                 }
-                queue_entry = std::move(_queue.front());
-                _queue.pop_front();
             }
-            LOG4CXX_TRACE(logger, "Start job");
+            else if (!pop(queue_entry)) {
+                break;
+            }
+            if (_elastic) {
+                dequeued(queue_entry);
+            }
+            if (queue_entry.staged) {
+                hold(queue_entry.deadline);  // NB: before the start => holding counts as idle time
+            }
+            auto start = started(*counters, &queue_entry);
+            run(queue_entry);
+            finished(*counters, start);
+        }
+
+        // NB: a suspended coroutine cannot be dropped => resume the local ones in place; rescheduling stays local
+        while (!worker.ready.empty()) {
+            auto handle = worker.ready.front();
+            worker.ready.pop_front();
+            handle.resume();
+        }
+        _current_worker = nullptr;
+        LOG4CXX_INFO(logger, "Stop");
+    }
+
+    void run(QueueEntry& queue_entry) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.thread_pool");
+#endif
+
+        if (queue_entry.coroutine) {
+            queue_entry.coroutine.resume();
+            return;
+        }
+        LOG4CXX_TRACE(logger, "Start job");
 #ifndef YATQ_DISABLE_FUTURES
-            internal::run_and_set_value<result_type>(std::move(queue_entry.job), std::move(queue_entry.promise));
+        if (queue_entry.slot) {
+            internal::run_and_complete<result_type>(queue_entry.job, queue_entry.slot);
+        }
+        else {
+            run_detached(queue_entry.job);
+        }
 #else
-            queue_entry.job();
+        run_detached(queue_entry.job);
 #endif
-            LOG4CXX_TRACE(logger, "Job complete");
+        LOG4CXX_TRACE(logger, "Job complete");
+    }
+
+    static std::int64_t nanoseconds(std::chrono::steady_clock::duration duration) noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    // NB: returns the job start; a default one => statistics disabled. the worker is the only writer => no RMW needed
+    TimePoint started(WorkerCounters& counters, const QueueEntry* queue_entry = nullptr) {
+        if (!_stats.load(std::memory_order_relaxed)) {
+            return TimePoint();
+        }
+        auto start = std::chrono::steady_clock::now();
+        auto start_ns = nanoseconds(start.time_since_epoch());
+        auto since = counters.since.load(std::memory_order_relaxed);
+        if (since != 0 && start_ns > since) {
+            counters.idle_time.store(counters.idle_time.load(std::memory_order_relaxed) + (start_ns - since), std::memory_order_relaxed);
+        }
+        if (queue_entry && queue_entry->enqueued != TimePoint()) {
+            // NB: a staged job is handed over early on purpose => it waits from its deadline
+            auto submitted = queue_entry->staged ? std::max(queue_entry->enqueued, queue_entry->deadline) : queue_entry->enqueued;
+            counters.wait_time.record(start > submitted ? nanoseconds(start - submitted) : 0);
+        }
+        counters.busy.store(true, std::memory_order_relaxed);
+        counters.since.store(start_ns, std::memory_order_relaxed);
+        return start;
+    }
+
+    void finished(WorkerCounters& counters, const TimePoint& start) {
+        if (start == TimePoint()) {
+            return;
         }
+        auto finish = std::chrono::steady_clock::now();
+        auto service_time = nanoseconds(finish - start);
+        counters.service_time.record(service_time);
+        counters.busy_time.store(counters.busy_time.load(std::memory_order_relaxed) + service_time, std::memory_order_relaxed);
+        counters.jobs.store(counters.jobs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counters.busy.store(false, std::memory_order_relaxed);
+        counters.since.store(nanoseconds(finish.time_since_epoch()), std::memory_order_relaxed);
+    }
 
-        LOG4CXX_INFO(logger, "Stop");
+    void hold(const std::chrono::steady_clock::time_point& deadline) {
+        if (_spinners.fetch_add(1, std::memory_order_relaxed) < _max_spinners.load(std::memory_order_relaxed)) {
+            internal::spin_until(deadline);
+        }
+        else {
+            std::this_thread::sleep_until(deadline);  // NB: too many spinners => give the CPU away
+        }
+        _spinners.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    static void run_detached(Executable& job) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.thread_pool");
+#endif
+
+        try {
+            job();
+        }
+        catch (const std::exception& exc) {
+            LOG4CXX_WARN(logger, std::format("Detached job failed: {}", exc.what()));
+        }
+        catch (...) {
+            LOG4CXX_WARN(logger, "Detached job failed");
+        }
     }
 };
 
@@ -2,48 +2,140 @@
 #define _YATQ_TIMER_QUEUE_H
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
 #include <format>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <system_error>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
-#ifndef YATQ_DISABLE_FUTURES
-#define BOOST_THREAD_PROVIDES_FUTURE
-#define BOOST_THREAD_PROVIDES_FUTURE_CONTINUATION
-#include <boost/thread/future.hpp>
-#endif
-
+#include "yatq/internal/cold_tier.h"
 #include "yatq/internal/concepts.h"
-#ifndef YATQ_DISABLE_FUTURES
-#include "yatq/internal/promise_utils.h"
-#endif
+#include "yatq/internal/coroutine_utils.h"
 #include "yatq/internal/log4cxx_proxy.h"
+#include "yatq/utils/counter_utils.h"
+#include "yatq/utils/histogram.h"
 #include "yatq/utils/logging_utils.h"
+#include "yatq/utils/mmap_utils.h"
+#include "yatq/utils/sync_utils.h"
 #ifndef YATQ_DISABLE_PTHREAD
 #include "yatq/utils/sched_utils.h"
 #endif
+#ifndef YATQ_DISABLE_FUTURES
+#include "yatq/completion.h"
+#endif
+#include "yatq/job_registry.h"
+#include "yatq/move_only_function.h"
 #include "yatq/thread_pool.h"
 
 namespace yatq {
 
 using internal::ClockGeneric;
 using internal::ExecutorGeneric;
+using internal::SyncGeneric;
 
-template<ExecutorGeneric _Executor = ThreadPool<>, ClockGeneric _Clock = std::chrono::system_clock>
+typedef struct {
+    /**
+     * hand the job over to the executor ahead of the deadline (see \a TimerQueue::set_stage_lookahead()) and let a
+     * worker busy-wait for the deadline instead of waking up at it. takes effect with executors able to stage jobs
+     * (see \a ThreadPool::stage()) and is ignored otherwise
+     */
+    bool stage = false;
+    /**
+     * run the job in the executor thread serving the key, after the jobs of the same key expired before (see
+     * \a KeyedThreadPool). ignored by executors without keys
+     */
+    std::optional<std::size_t> key;
+    /**
+     * job kind for executors able to run cheap jobs inline in the timer queue thread (see \a HybridExecutor). ignored by
+     * other executors
+     */
+    std::optional<std::size_t> inline_kind;
+    /**
+     * timer priority; the higher the more important. see \a TimerQueue::set_capacity() and
+     * \a TimerQueue::set_max_lateness()
+     */
+    int priority = 0;
+} TimerOptions;
+
+/**
+ * what \a TimerQueue::enqueue() does when the queue is full. see \a TimerQueue::set_capacity()
+ */
+typedef enum {fail_when_full, evict_when_full} admission_policy_t;
+
+typedef struct {
+    /**
+     * timers refused because the queue was full
+     */
+    std::size_t rejected;
+    /**
+     * pending timers evicted to make room for more important ones
+     */
+    std::size_t evicted;
+    /**
+     * timers discarded for being too late
+     */
+    std::size_t late;
+} ShedStats;
+
+/**
+ * timer queue statistics, see \a TimerQueue::stats()
+ */
+typedef struct {
+    std::uint64_t enqueued;
+    std::uint64_t fired;  // NB: handed over to the executor or resumed
+    std::uint64_t canceled;
+    std::uint64_t tombstones;  // NB: canceled timers popped from the heap
+    std::size_t live_timers;
+    std::size_t heap_size;
+    std::size_t heap_capacity;
+    std::uint64_t timeout_wakeups;
+    std::uint64_t notified_wakeups;
+    std::uint64_t spurious_wakeups;
+    utils::HistogramSummary lateness;  // NB: nanoseconds from the deadline to the hand-over
+} TimerQueueStats;
+
+/**
+ * what \a TimerQueue::restore() does with timers whose deadline has passed
+ */
+typedef enum {fire_expired, drop_expired} expired_policy_t;
+
+template<
+    ExecutorGeneric _Executor = ThreadPool<>,
+    ClockGeneric _Clock = std::chrono::system_clock,
+    SyncGeneric _Sync = utils::StdSync
+>
 class TimerQueue {
 public:
     using Clock = _Clock;
     using Executor = _Executor;
+    using Sync = _Sync;
     using Executable = Executor::Executable;
-    using result_type = Executable::result_type;
+    using result_type = internal::executable_result_t<Executable>;
 #ifndef YATQ_DISABLE_FUTURES
-    using Future = boost::future<result_type>;  // NB: doesn't have to match 'Executor::Future'
+    using Future = CompletionHandle<result_type>;  // NB: doesn't have to match 'Executor::Future'
+    using Callback = typename Future::Continuation;  // NB: same type => not wrapped (and heap allocated) by \a then()
 #endif
 
     using uid_t = unsigned int;
+    using LateCallback = MoveOnlyFunction<void(uid_t, const typename Clock::time_point&)>;
+    using RestoreCallback = MoveOnlyFunction<void(uid_t, const JobDescriptor&)>;
 
     typedef struct {
         /**
@@ -64,14 +156,23 @@ public:
 
 private:
 #ifndef YATQ_DISABLE_FUTURES
-    using Promise = boost::promise<result_type>;
+    using Slot = CompletionSlot<result_type>;
 #endif
+    using Mutex = Sync::mutex;
+    using ConditionVariable = Sync::condition_variable;
 
     typedef struct {
         Executable job;
 #ifndef YATQ_DISABLE_FUTURES
-        Promise promise;
+        Slot slot;
 #endif
+        internal::SleepState* sleeper;  // NB: set for suspended coroutines only
+        Clock::time_point stage_deadline;  // NB: set for staged jobs only
+        std::optional<std::size_t> key;
+        std::optional<std::size_t> inline_kind;
+        int priority;
+        bool cold;  // NB: set for cold tier page-in timers only
+        std::unique_ptr<JobDescriptor> descriptor;  // NB: set for timers enqueued with a job descriptor only
     } MapEntry;
 
     typedef struct {
@@ -79,21 +180,98 @@ private:
         Clock::time_point deadline;
     } HeapEntry;
 
+    static constexpr std::uint32_t snapshot_version = 1;
+    static constexpr std::uint32_t snapshot_staged = 1;
+
+    typedef struct {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t record_size;
+        std::int64_t period_num;
+        std::int64_t period_den;
+        std::uint64_t count;
+    } SnapshotHeader;
+
+    typedef struct {
+        std::int64_t deadline;  // NB: 'Clock' ticks since epoch
+        std::int32_t priority;
+        std::uint32_t flags;
+        JobDescriptor descriptor;
+    } SnapshotRecord;
+
     bool _running;
-    uid_t _next_uid;
-    mutable std::mutex _lock;
-    std::condition_variable _cond;
+    std::atomic<uid_t> _next_uid;
+    mutable Mutex _lock;
+    ConditionVariable _cond;
     std::unordered_map<uid_t, MapEntry> _jobs;
     std::vector<HeapEntry> _heap;
+    double _purge_ratio;  // NB: guarded by '_lock', as well as the two below
+    std::size_t _purge_slice;
+    std::size_t _purge_cursor;  // NB: heap entries left to check by the running purge; 0 => none running
+    std::size_t _purged;
+    Clock::duration _stage_lookahead;
+    std::size_t _capacity;  // NB: 0 => unbounded
+    admission_policy_t _admission;
+    std::set<std::pair<int, uid_t>> _by_priority;  // NB: pending job timers by priority, then age; 'evict_when_full' only
+    std::size_t _job_timers;  // NB: pending job timers, i.e. neither sleepers nor page-in timers; guarded by '_lock'
+    Clock::duration _max_lateness;  // NB: 0 => off
+    int _max_shed_priority;
+    LateCallback _on_late;
+    std::atomic<std::size_t> _rejected;
+    std::atomic<std::size_t> _evicted;
+    std::atomic<std::size_t> _late;
+    utils::ShardedCounter<> _enqueued;  // NB: sharded => producers do not contend on it
+    utils::ShardedCounter<> _canceled;
+    std::atomic<std::uint64_t> _fired;  // NB: updated by the timer queue thread only, as well as the five below
+    std::atomic<std::uint64_t> _tombstones;
+    std::atomic<std::uint64_t> _timeout_wakeups;
+    std::atomic<std::uint64_t> _notified_wakeups;
+    std::atomic<std::uint64_t> _spurious_wakeups;
+    utils::Histogram _lateness;
+    std::atomic<std::size_t> _live_timers;  // NB: updated under '_lock', as well as the two below
+    std::atomic<std::size_t> _heap_size;
+    std::atomic<std::size_t> _heap_capacity;
     Executor* const _executor;
+    JobRegistry<Executable> _job_registry;
+    std::unique_ptr<internal::ColdTier> _cold;  // NB: null => no cold tier; guarded by '_cold_lock'
+    Clock::duration _cold_horizon;
+    mutable Mutex _cold_lock;  // NB: taken before '_lock' when both are needed
     std::thread _thread;
+#ifndef YATQ_DISABLE_FUTURES
+    CompletionPool<result_type, Sync> _completions;
+#endif
 
 public:
     /**
      * create timer queue
      * @param executor raw pointer to the job executor; cannot be \a nullptr. ownership not taken
      */
-    explicit TimerQueue(Executor* executor): _running(false), _next_uid(0), _executor(executor) {}
+    explicit TimerQueue(Executor* executor):
+        _running(false),
+        _next_uid(0),
+        _purge_ratio(0.5),
+        _purge_slice(1024),
+        _purge_cursor(0),
+        _purged(0),
+        _stage_lookahead(std::chrono::duration_cast<typename Clock::duration>(std::chrono::microseconds(50))),
+        _capacity(0),
+        _admission(fail_when_full),
+        _job_timers(0),
+        _max_lateness(Clock::duration::zero()),
+        _max_shed_priority(0),
+        _rejected(0),
+        _evicted(0),
+        _late(0),
+        _fired(0),
+        _tombstones(0),
+        _timeout_wakeups(0),
+        _notified_wakeups(0),
+        _spurious_wakeups(0),
+        _live_timers(0),
+        _heap_size(0),
+        _heap_capacity(0),
+        _executor(executor),
+        _cold_horizon(Clock::duration::zero()) {}
 
     /**
      * start timer queue thread with default scheduling parameters
@@ -127,6 +305,123 @@ public:
     }
 #endif
 
+    /**
+     * set how long before the deadline staged timers are handed over to the executor (see \a TimerOptions::stage).
+     * it should cover the executor wake-up latency; the worker burns CPU for that long. not thread safe: call it before
+     * enqueueing staged timers
+     * @param lookahead staging lookahead; 50us by default
+     */
+    void set_stage_lookahead(const Clock::duration& lookahead) {
+        _stage_lookahead = lookahead;
+    }
+
+    /**
+     * set automatic purge of canceled timers: once they make up more than \a ratio of the queue, the timer queue thread
+     * deletes them while waiting for the next deadline, checking at most \a slice timers at a time and releasing the
+     * lock in between, and then shrinks the queue storage. a timer due while a slice runs is late by that slice at most.
+     * on by default
+     * @param ratio canceled timers ratio to start at; 0.5 by default, 0 turns automatic purge off
+     * @param slice max number of timers checked at a time; 1024 by default
+     */
+    void set_auto_purge(double ratio, std::size_t slice = 1024) {
+        {
+            std::lock_guard<Mutex> guard(_lock);
+            _purge_ratio = ratio;
+            _purge_slice = std::max<std::size_t>(slice, 1);
+        }
+        _cond.notify_one();
+    }
+
+    /**
+     * bound the number of pending timers (coroutines awaiting \a sleep_until() and the like are not counted). when the
+     * queue is full, \a enqueue() throws \a std::runtime_error, or under \a evict_when_full evicts the least important
+     * (lowest priority, then oldest) pending timer if it has lower priority than the new one; an evicted timer fails
+     * with \a std::runtime_error. not thread safe: call it before enqueueing timers
+     * @param capacity max number of pending timers; 0 => unbounded (default)
+     * @param policy \a fail_when_full | \a evict_when_full
+     */
+    void set_capacity(std::size_t capacity, admission_policy_t policy = fail_when_full) {
+        _capacity = capacity;
+        _admission = policy;
+    }
+
+    /**
+     * shed timers running late: a timer with priority up to \a max_priority expiring more than \a max_lateness past its
+     * deadline is not executed but fails with \a std::runtime_error and is reported to the optional callback. not thread
+     * safe: call it before enqueueing timers
+     * @param max_lateness max lateness; 0 turns shedding off (default)
+     * @param max_priority max priority of the timers to shed; 0 by default
+     * @param on_late optional callback; \a void(uid_t, deadline). called in the timer queue thread => keep it short
+     */
+    void set_max_lateness(
+        const Clock::duration& max_lateness,
+        int max_priority = 0,
+        LateCallback on_late = {}
+    ) {
+        _max_lateness = max_lateness;
+        _max_shed_priority = max_priority;
+        _on_late = std::move(on_late);
+    }
+
+    /**
+     * @return rejected, evicted and late timer counts so far
+     */
+    ShedStats shed_stats() const noexcept {
+        return {
+            _rejected.load(std::memory_order_relaxed),
+            _evicted.load(std::memory_order_relaxed),
+            _late.load(std::memory_order_relaxed)
+        };
+    }
+
+    /**
+     * keep far-future timers on disk rather than in memory. timers enqueued by \a enqueue_detached() with a job
+     * descriptor (and neither \a TimerOptions::key nor \a TimerOptions::inline_kind) go to append-only memory-mapped
+     * segment files, one per bucket of deadlines, unless the bucket starts within the horizon. the timer queue thread
+     * pages a bucket back in as soon as it gets within the horizon. the timer uid stays valid for \a cancel(). cold
+     * timers do not count against the capacity (see \a set_capacity()). segment files are deleted once paged in, as
+     * well as on \a clear() and destruction. not thread safe: call it before enqueueing timers
+     * @param directory existing directory for segment files; not to be shared with other timer queues
+     * @param horizon how far ahead buckets are paged in; it should cover the page-in time of a bucket
+     * @param bucket bucket width, e.g. an hour
+     */
+    void set_cold_tier(const std::string& directory, const Clock::duration& horizon, const Clock::duration& bucket)
+    requires std::default_initializable<Executable> {
+        if (bucket <= Clock::duration::zero()) {
+            throw std::invalid_argument("Cold tier bucket width must be positive");
+        }
+        _cold = std::make_unique<internal::ColdTier>(directory, bucket.count());
+        _cold_horizon = horizon;
+    }
+
+    /**
+     * @return number of pending timers kept on disk (see \a set_cold_tier())
+     */
+    std::size_t cold_timers() const {
+        std::lock_guard<Mutex> cold_guard(_cold_lock);
+        return _cold ? _cold->size() : 0;
+    }
+
+    /**
+     * timer queue statistics. lock-free: counters and gauges are read one by one, i.e. not as of a single instant
+     * @return counters, gauges, timer queue thread wake-ups (on timeout, notified, spurious) and lateness percentiles
+     */
+    TimerQueueStats stats() const noexcept {
+        return {
+            _enqueued.value(),
+            _fired.load(std::memory_order_relaxed),
+            _canceled.value(),
+            _tombstones.load(std::memory_order_relaxed),
+            _live_timers.load(std::memory_order_relaxed),
+            _heap_size.load(std::memory_order_relaxed),
+            _heap_capacity.load(std::memory_order_relaxed),
+            _timeout_wakeups.load(std::memory_order_relaxed),
+            _notified_wakeups.load(std::memory_order_relaxed),
+            _spurious_wakeups.load(std::memory_order_relaxed),
+            _lateness.summary()
+        };
+    }
+
     /**
      * stop timer queue thread
      */
@@ -147,41 +442,311 @@ public:
      * @return timer handle to obtain result or cancel
      */
     TimerHandle enqueue(const Clock::time_point& deadline, Executable job) {
-#ifndef YATQ_DISABLE_LOGGING
-        static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
+#ifndef YATQ_DISABLE_FUTURES
+        auto [slot, future] = _completions.make();
+        auto uid = insert(deadline, {std::move(job), std::move(slot)});
+        return {uid, deadline, std::move(future)};
+#else
+        auto uid = insert(deadline, {std::move(job)});
+        return {uid, deadline};
 #endif
+    }
 
+    /**
+     * add timed job with options to the queue
+     * @param deadline scheduled execution timepoint
+     * @param job job to execute
+     * @param options timer options
+     * @return timer handle to obtain result or cancel
+     */
+    TimerHandle enqueue(const Clock::time_point& deadline, Executable job, const TimerOptions& options) {
 #ifndef YATQ_DISABLE_FUTURES
-        Promise promise;
-        auto future = promise.get_future();
+        auto [slot, future] = _completions.make();
+        auto uid = insert(deadline, {std::move(job), std::move(slot)}, options);
+        return {uid, deadline, std::move(future)};
+#else
+        auto uid = insert(deadline, {std::move(job)}, options);
+        return {uid, deadline};
 #endif
-        uid_t uid;
-        bool is_first;
-        {
-            std::lock_guard<std::mutex> guard(_lock);
-            uid = _next_uid++;
-            MapEntry map_entry {
-                std::move(job)
+    }
+
 #ifndef YATQ_DISABLE_FUTURES
-                , std::move(promise)
+    /**
+     * add timed job to the queue and deliver its result to a callback
+     * @param deadline scheduled execution timepoint
+     * @param job job to execute
+     * @param on_complete callback; \a void(Future). called in the thread executing the job (or canceling the timer)
+     * with a ready future: use \a get() to obtain job result or exception. not called if the queue is full: \a enqueue()
+     * throws then
+     * @return timer uid
+     */
+    uid_t enqueue(const Clock::time_point& deadline, Executable job, Callback on_complete) {
+        auto [slot, future] = _completions.make();
+        auto uid = insert(deadline, {std::move(job), std::move(slot)});
+        future.then(std::move(on_complete));  // NB: once admitted => a full queue is reported by the exception only
+        return uid;
+    }
 #endif
-            };
-            _jobs.insert(std::make_pair(uid, std::move(map_entry)));
-            _heap.push_back(HeapEntry {uid, deadline});
-            std::push_heap(_heap.begin(), _heap.end(), TimerQueue::heap_cmp);
-            is_first = (_heap[0].uid == uid);
+
+    /**
+     * add timed job to the queue discarding its result. no promise is allocated
+     * @param deadline scheduled execution timepoint
+     * @param job job to execute
+     * @return timer uid
+     */
+    uid_t enqueue_detached(const Clock::time_point& deadline, Executable job) {
+        return insert(deadline, {std::move(job)});
+    }
+
+    /**
+     * add timed job with options to the queue discarding its result. no promise is allocated
+     * @param deadline scheduled execution timepoint
+     * @param job job to execute
+     * @param options timer options
+     * @return timer uid
+     */
+    uid_t enqueue_detached(const Clock::time_point& deadline, Executable job, const TimerOptions& options) {
+        return insert(deadline, {std::move(job)}, options);
+    }
+
+    /**
+     * add timed job given by a job descriptor to the queue. unlike other timers, it is saved by \a snapshot()
+     * @param deadline scheduled execution timepoint
+     * @param descriptor job descriptor; its type must be registered (see \a job_registry())
+     * @param options timer options
+     * @return timer handle to obtain result or cancel
+     */
+    TimerHandle enqueue(const Clock::time_point& deadline, const JobDescriptor& descriptor, const TimerOptions& options = {}) {
+#ifndef YATQ_DISABLE_FUTURES
+        auto [slot, future] = _completions.make();
+        MapEntry map_entry {_job_registry.make(descriptor), std::move(slot)};
+        map_entry.descriptor = std::make_unique<JobDescriptor>(descriptor);
+        auto uid = insert(deadline, std::move(map_entry), options);
+        return {uid, deadline, std::move(future)};
+#else
+        MapEntry map_entry {_job_registry.make(descriptor)};
+        map_entry.descriptor = std::make_unique<JobDescriptor>(descriptor);
+        auto uid = insert(deadline, std::move(map_entry), options);
+        return {uid, deadline};
+#endif
+    }
+
+    /**
+     * add timed job given by a job descriptor to the queue discarding its result. see
+     * \a enqueue(const Clock::time_point&, const JobDescriptor&, const TimerOptions&). a far-future timer may be kept on
+     * disk (see \a set_cold_tier())
+     * @param deadline scheduled execution timepoint
+     * @param descriptor job descriptor; its type must be registered (see \a job_registry())
+     * @param options timer options
+     * @return timer uid
+     */
+    uid_t enqueue_detached(const Clock::time_point& deadline, const JobDescriptor& descriptor, const TimerOptions& options = {}) {
+        if (_cold && !options.key && !options.inline_kind && cold(deadline)) {
+            return freeze(deadline, descriptor, options.priority, options.stage);
         }
-        if (is_first) {
-            _cond.notify_one();
+        MapEntry map_entry {_job_registry.make(descriptor)};
+        map_entry.descriptor = std::make_unique<JobDescriptor>(descriptor);
+        return insert(deadline, std::move(map_entry), options);
+    }
+
+    /**
+     * job factories for timers enqueued with job descriptors and restored from snapshots. not thread safe: register job
+     * types before enqueueing such timers
+     */
+    JobRegistry<Executable>& job_registry() noexcept {
+        return _job_registry;
+    }
+
+    /**
+     * awaitable suspending a coroutine until the deadline. resumed by the executor if it can resume coroutines (see
+     * \a ThreadPool::resume()), by the timer queue thread otherwise. must be awaited at most once
+     */
+    class SleepAwaitable {
+    private:
+        struct StopCallback {
+            TimerQueue* tq;
+            uid_t uid;
+
+            void operator()() const {
+                tq->cancel(uid);
+            }
+        };
+
+        TimerQueue* const _tq;
+        const Clock::time_point _deadline;
+        const uid_t _uid;
+        const std::stop_token _stop_token;
+        internal::SleepState _state;
+        std::optional<std::stop_callback<StopCallback>> _stop_callback;
+
+        friend class TimerQueue;
+
+        SleepAwaitable(TimerQueue* tq, const Clock::time_point& deadline, std::stop_token&& stop_token):
+            _tq(tq),
+            _deadline(deadline),
+            _uid(tq->_next_uid.fetch_add(1, std::memory_order_relaxed)),
+            _stop_token(std::move(stop_token)),
+            _state {nullptr, false} {}
+
+    public:
+        SleepAwaitable(const SleepAwaitable&) = delete;
+        SleepAwaitable& operator=(const SleepAwaitable&) = delete;
+
+        /**
+         * timer uid, valid before the coroutine is suspended. use it to cancel the timer
+         */
+        uid_t uid() const noexcept {
+            return _uid;
         }
-        LOG4CXX_DEBUG(logger, std::format("New timer uid={}", uid));
-        return {
-            uid
-            , deadline
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            _state.handle = handle;
+            if (_stop_token.stop_possible()) {
+                _stop_callback.emplace(_stop_token, StopCallback {_tq, _uid});
+            }
 #ifndef YATQ_DISABLE_FUTURES
-            , std::move(future)
+            auto inserted = _tq->insert(_uid, _deadline, {Executable(), Slot(), &_state}, _stop_token);
+#else
+            auto inserted = _tq->insert(_uid, _deadline, {Executable(), &_state}, _stop_token);
 #endif
+            if (!inserted) {
+                _state.canceled = true;  // NB: stop requested before suspension => don't suspend
+            }
+            return inserted;
+        }
+
+        /**
+         * @return \a true if the deadline expired; \a false if the timer was canceled
+         */
+        bool await_resume() noexcept {
+            _stop_callback.reset();
+            return !_state.canceled;
+        }
+    };
+
+    /**
+     * suspend coroutine until the deadline:  co_await timer_queue.sleep_until(deadline). no job object, result slot or
+     * executor round trip is involved
+     * @param deadline resumption timepoint
+     * @param stop_token stop token; stop request cancels the timer and resumes the coroutine right away
+     * @return awaitable; \a co_await yields \a true if the deadline expired, \a false if the timer was canceled
+     */
+    SleepAwaitable sleep_until(const Clock::time_point& deadline, std::stop_token stop_token = {})
+    requires std::default_initializable<Executable> {
+        return SleepAwaitable(this, deadline, std::move(stop_token));
+    }
+
+    /**
+     * awaitable racing another awaitable against a deadline. see \a when_timeout()
+     */
+    template<typename Awaitable>
+    class TimeoutAwaitable {
+    private:
+        using Value = std::decay_t<internal::await_result_t<Awaitable>>;
+        using Result = std::conditional_t<std::is_void_v<Value>, bool, std::optional<Value>>;
+
+        // NB: shared by the awaiting coroutine and the two racing helpers
+        struct Race {
+            std::atomic<bool> done = false;
+            std::atomic<bool> suspended = false;
+            std::coroutine_handle<> handle;
+            uid_t uid;
+            Result result {};
+            std::exception_ptr exception;
+
+            void finish() {
+                if (suspended.exchange(true, std::memory_order_acq_rel)) {
+                    handle.resume();
+                }
+            }
         };
+
+        TimerQueue* const _tq;
+        const Clock::time_point _deadline;
+        Awaitable _awaitable;
+        std::shared_ptr<Race> _race;
+
+        friend class TimerQueue;
+
+        TimeoutAwaitable(TimerQueue* tq, Awaitable&& awaitable, const Clock::time_point& deadline):
+            _tq(tq),
+            _deadline(deadline),
+            _awaitable(std::move(awaitable)),
+            _race(std::make_shared<Race>()) {}
+
+        static internal::DetachedCoroutine run_timer(TimerQueue* tq, Clock::time_point deadline, std::shared_ptr<Race> race) {
+            auto sleep = tq->sleep_until(deadline);
+            race->uid = sleep.uid();
+            auto expired = co_await sleep;
+            if (expired && !race->done.exchange(true, std::memory_order_acq_rel)) {
+                race->finish();  // NB: result stays empty
+            }
+        }
+
+        static internal::DetachedCoroutine run_awaitable(TimerQueue* tq, Awaitable awaitable, std::shared_ptr<Race> race) {
+            Result result {};
+            std::exception_ptr exception;
+            try {
+                if constexpr (std::is_void_v<Value>) {
+                    co_await std::move(awaitable);
+                    result = true;
+                }
+                else {
+                    result.emplace(co_await std::move(awaitable));
+                }
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+            if (!race->done.exchange(true, std::memory_order_acq_rel)) {
+                race->result = std::move(result);
+                race->exception = std::move(exception);
+                tq->cancel(race->uid);  // NB: resumes the timer helper which finds the race over
+                race->finish();
+            }
+        }
+
+    public:
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            _race->handle = handle;
+            run_timer(_tq, _deadline, _race);  // NB: first => timer uid is known before the awaitable may complete
+            run_awaitable(_tq, std::move(_awaitable), _race);
+            return !_race->suspended.exchange(true, std::memory_order_acq_rel);
+        }
+
+        /**
+         * @return awaitable result wrapped into \a std::optional (\a true for \a void awaitables) if it completed
+         * before the deadline; \a std::nullopt (\a false) otherwise
+         * @throw awaitable exception
+         */
+        Result await_resume() {
+            if (_race->exception) {
+                std::rethrow_exception(_race->exception);
+            }
+            return std::move(_race->result);
+        }
+    };
+
+    /**
+     * race an awaitable against a deadline:  co_await timer_queue.when_timeout(awaitable, deadline). the timer is
+     * canceled as soon as the awaitable completes. the awaitable is not interrupted on timeout: it runs to completion
+     * and its result is discarded
+     * @param awaitable awaitable to race; taken by value
+     * @param deadline timeout timepoint
+     * @return awaitable; \a co_await yields \a std::optional of the awaitable result (\a bool for \a void awaitables)
+     */
+    template<typename Awaitable>
+    TimeoutAwaitable<Awaitable> when_timeout(Awaitable awaitable, const Clock::time_point& deadline)
+    requires std::default_initializable<Executable> {
+        return TimeoutAwaitable<Awaitable>(this, std::move(awaitable), deadline);
     }
 
     /**
@@ -194,25 +759,24 @@ public:
         static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
 #endif
 
-        bool was_removed;
-        bool was_first;
-        {
-            std::lock_guard<std::mutex> guard(_lock);
-            auto i = _jobs.find(uid);
-            if (i != _jobs.end()) {
-                LOG4CXX_DEBUG(logger, std::format("Canceling timer uid={}", uid));
-                _jobs.erase(i);
-                was_removed = true;
-                was_first = (_heap[0].uid == uid);
-            }
-            else {
-                was_removed = false;
-            }
+        if (cancel_pending(uid)) {
+            _canceled.add();
+            return true;
         }
-        if (was_removed && was_first) {
-            _cond.notify_one();
+        if (!_cold) {
+            return false;
         }
-        return was_removed;
+        std::lock_guard<Mutex> cold_guard(_cold_lock);  // NB: held while paging in => the timer is either on disk or in memory
+        if (_cold->cancel(uid)) {
+            LOG4CXX_DEBUG(logger, std::format("Canceling cold timer uid={}", uid));
+            _canceled.add();
+            return true;
+        }
+        if (cancel_pending(uid)) {
+            _canceled.add();
+            return true;
+        }
+        return false;
     }
 
     /**
@@ -223,20 +787,44 @@ public:
         static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
 #endif
 
+        std::unique_lock<Mutex> cold_guard(_cold_lock, std::defer_lock);
+        [[maybe_unused]] std::size_t total_cold = 0;  // NB: logged only
+        if (_cold) {
+            cold_guard.lock();  // NB: held until page-in timers are gone too
+            total_cold = _cold->size();
+            _cold->clear();
+        }
         std::size_t total_jobs;
         std::size_t total_timers;
+        decltype(_jobs) jobs;  // NB: destroyed (and thus result slots released) outside the lock
         {
-            std::lock_guard<std::mutex> guard(_lock);
+            std::lock_guard<Mutex> guard(_lock);
             total_jobs = _jobs.size();
-            _jobs.clear();
+            _jobs.swap(jobs);
+            _by_priority.clear();
+            _job_timers = 0;
             total_timers = _heap.size();
             _heap.clear();
+            _purge_cursor = 0;
+            update_gauges();
+        }
+        if (cold_guard.owns_lock()) {
+            cold_guard.unlock();
         }
         if (total_jobs > 0) {
             _cond.notify_one();
         }
+        for (auto&& [uid, map_entry]: jobs) {
+            if (map_entry.sleeper) {
+                map_entry.sleeper->canceled = true;
+                resume(map_entry.sleeper->handle);
+            }
+        }
         auto canceled_timers = total_timers - total_jobs;
-        LOG4CXX_DEBUG(logger, std::format("Cleared {} timers and {} canceled timers", total_jobs, canceled_timers));
+        LOG4CXX_DEBUG(
+            logger,
+            std::format("Cleared {} timers, {} cold timers and {} canceled timers", total_jobs, total_cold, canceled_timers)
+        );
     }
 
     /**
@@ -249,7 +837,7 @@ public:
 
         std::size_t canceled_timers;
         {
-            std::lock_guard<std::mutex> guard(_lock);
+            std::lock_guard<Mutex> guard(_lock);
             auto total_jobs = _jobs.size();
             auto total_timers = _heap.size();
             canceled_timers = total_timers - total_jobs;
@@ -266,26 +854,664 @@ public:
                 }
                 std::make_heap(heap.begin(), heap.end(), TimerQueue::heap_cmp);
                 _heap.swap(heap);
+                _purge_cursor = 0;
+                update_gauges();
             }
         }
         // NB: 'demux()' never waits on a canceled timer => no need to notify
         LOG4CXX_DEBUG(logger, std::format("Purged {} canceled timers", canceled_timers));
     }
 
+    /**
+     * save pending timers enqueued with job descriptors to a memory-mapped file: deadline, priority, staging and job
+     * descriptor each. other timers are skipped. the file is written aside and renamed, so an existing snapshot is
+     * replaced atomically. deadlines are saved as \a Clock time since epoch, i.e. a snapshot outlives a restart with a
+     * system-wide clock only (e.g. the default \a std::chrono::system_clock). the queue is locked while the in-memory
+     * timers are copied, i.e. for a walk over the heap: expiration and \a enqueue() wait meanwhile, though not for the
+     * cold tier walk or the file write
+     * @param path snapshot file path
+     * @return number of timers saved
+     */
+    std::size_t snapshot(const std::string& path) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
+#endif
+
+        std::vector<SnapshotRecord> records;
+        {
+            std::lock_guard<Mutex> cold_guard(_cold_lock);  // NB: no timer is paged in meanwhile
+            std::unique_lock<Mutex> guard(_lock);
+            records.reserve(_jobs.size() + (_cold ? _cold->size() : 0));
+            for (auto&& heap_entry: _heap) {
+                auto i = _jobs.find(heap_entry.uid);
+                if (i == _jobs.end() || !i->second.descriptor) {
+                    continue;
+                }
+                auto& map_entry = i->second;
+                bool staged = (map_entry.stage_deadline != typename Clock::time_point());
+                auto deadline = staged ? map_entry.stage_deadline : heap_entry.deadline;
+                records.push_back(
+                    SnapshotRecord {
+                        static_cast<std::int64_t>(deadline.time_since_epoch().count()),
+                        map_entry.priority,
+                        staged ? snapshot_staged : 0,
+                        *map_entry.descriptor
+                    }
+                );
+            }
+            guard.unlock();  // NB: the cold tier is guarded by '_cold_lock' alone
+            if (_cold) {
+                _cold->for_each(
+                    [&records] (const internal::ColdRecord& record) {
+                        auto flags = (record.flags & internal::cold_staged) ? snapshot_staged : 0;
+                        records.push_back(SnapshotRecord {record.deadline, record.priority, flags, record.descriptor});
+                    }
+                );
+            }
+        }
+
+        SnapshotHeader header {
+            {'Y', 'A', 'T', 'Q', 'S', 'N', 'A', 'P'},
+            snapshot_version,
+            sizeof(SnapshotRecord),
+            Clock::period::num,
+            Clock::period::den,
+            records.size()
+        };
+        auto tmp_path = path + ".tmp";
+        {
+            utils::MappedFile file(tmp_path, sizeof(SnapshotHeader) + records.size() * sizeof(SnapshotRecord));
+            std::memcpy(file.data(), &header, sizeof(SnapshotHeader));
+            if (!records.empty()) {
+                std::memcpy(file.data() + sizeof(SnapshotHeader), records.data(), records.size() * sizeof(SnapshotRecord));
+            }
+            file.sync();
+        }
+        if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+            throw std::system_error(errno, std::generic_category(), "rename " + tmp_path);
+        }
+        LOG4CXX_INFO(logger, std::format("Saved {} timers to {}", records.size(), path));
+        return records.size();
+    }
+
+    /**
+     * enqueue timers saved by \a snapshot(). jobs are made by the job registry (see \a job_registry()), which must know
+     * all the saved job types; results are discarded. all the jobs are made before any timer is enqueued, so an
+     * unregistered job type or a throwing factory leaves the queue untouched. far-future timers go to the cold tier, if
+     * any (see \a set_cold_tier()); should that fail on I/O, or \a on_restore throw, the timers already frozen are
+     * canceled (see \a cancel()) and no in-memory timer is enqueued. the heap is rebuilt at once rather than timer by
+     * timer, and the capacity limit (see \a set_capacity()) is not applied
+     * @param path snapshot file path
+     * @param expired \a fire_expired (default) to run timers whose deadline has passed right away | \a drop_expired
+     * @param on_restore optional callback; \a void(uid_t, const JobDescriptor&). called for every restored timer, e.g.
+     * to map the new uids for cancellation: after the cold timers are frozen but before any in-memory timer is enqueued
+     * @return number of timers restored
+     */
+    std::size_t restore(const std::string& path, expired_policy_t expired = fire_expired, RestoreCallback on_restore = {}) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
+#endif
+
+        utils::MappedFile file(path);
+        SnapshotHeader header;
+        if (file.size() < sizeof(SnapshotHeader)) {
+            throw std::runtime_error("Bad timer queue snapshot " + path);
+        }
+        std::memcpy(&header, file.data(), sizeof(SnapshotHeader));
+        if (
+            std::memcmp(header.magic, "YATQSNAP", sizeof(header.magic)) != 0 ||
+            header.version != snapshot_version ||
+            header.record_size != sizeof(SnapshotRecord) ||
+            file.size() != sizeof(SnapshotHeader) + header.count * sizeof(SnapshotRecord)
+        ) {
+            throw std::runtime_error("Bad timer queue snapshot " + path);
+        }
+        if (header.period_num != Clock::period::num || header.period_den != Clock::period::den) {
+            throw std::runtime_error("Timer queue snapshot " + path + " was taken with another clock");
+        }
+
+        auto now = Clock::now();
+        decltype(_jobs) entries;  // NB: built outside the lock, then spliced node by node
+        std::vector<HeapEntry> heap_entries;
+        entries.reserve(header.count);
+        heap_entries.reserve(header.count);
+        std::vector<std::pair<uid_t, JobDescriptor>> revived;  // NB: reported once every job is made
+        std::vector<SnapshotRecord> frozen;  // NB: frozen once every job is made
+        std::size_t dropped = 0;
+        for (std::size_t i = 0; i < header.count; ++i) {
+            SnapshotRecord record;
+            std::memcpy(&record, file.data() + sizeof(SnapshotHeader) + i * sizeof(SnapshotRecord), sizeof(SnapshotRecord));
+            typename Clock::time_point deadline {typename Clock::duration(record.deadline)};
+            if (expired == drop_expired && deadline < now) {
+                ++dropped;
+                continue;
+            }
+            if (_cold && cold(deadline)) {
+                if (!_job_registry.contains(record.descriptor.type)) {
+                    throw std::out_of_range(std::format("Job type {} is not registered", record.descriptor.type));
+                }
+                frozen.push_back(record);
+                continue;
+            }
+            auto uid = _next_uid.fetch_add(1, std::memory_order_relaxed);
+            bool staged = (record.flags & snapshot_staged);
+            heap_entries.push_back(revive(uid, deadline, record.priority, staged, record.descriptor, entries));
+            if (on_restore) {
+                revived.emplace_back(uid, record.descriptor);
+            }
+        }
+        file.close();
+
+        // NB: no bad record past this point, but freezing may fail on I/O and so may the callback => cancel what is frozen
+        std::vector<uid_t> frozen_uids;
+        frozen_uids.reserve(frozen.size());
+        try {
+            for (auto&& record: frozen) {
+                typename Clock::time_point deadline {typename Clock::duration(record.deadline)};
+                frozen_uids.push_back(freeze(deadline, record.descriptor, record.priority, record.flags & snapshot_staged));
+            }
+            if (on_restore) {
+                for (std::size_t i = 0; i < frozen.size(); ++i) {
+                    on_restore(frozen_uids[i], frozen[i].descriptor);
+                }
+                for (auto&& [uid, descriptor]: revived) {
+                    on_restore(uid, descriptor);
+                }
+            }
+        }
+        catch (...) {
+            for (auto uid: frozen_uids) {
+                cancel(uid);
+            }
+            throw;
+        }
+
+        auto count = entries.size() + frozen.size();
+        _enqueued.add(entries.size());
+        splice(entries, heap_entries);
+        _cond.notify_one();
+        LOG4CXX_INFO(logger, std::format("Restored {} timers from {}, dropped {} expired", count, path, dropped));
+        return count;
+    }
+
     /**
      * check whether a job is still in the queue
      * @param uid timer uid
      */
     bool in_queue(uid_t uid) const {
-        std::lock_guard<std::mutex> guard(_lock);
+        std::lock_guard<Mutex> guard(_lock);
         return _jobs.contains(uid);
     }
 
 private:
+    uid_t insert(const Clock::time_point& deadline, MapEntry&& map_entry) {
+        auto uid = _next_uid.fetch_add(1, std::memory_order_relaxed);
+        insert(uid, deadline, std::move(map_entry));
+        return uid;
+    }
+
+    uid_t insert(const Clock::time_point& deadline, MapEntry&& map_entry, const TimerOptions& options) {
+        map_entry.priority = options.priority;
+        if constexpr (internal::KeyedExecutorGeneric<Executor>) {
+            map_entry.key = options.key;
+        }
+        if constexpr (internal::InlineExecutorGeneric<Executor>) {
+            map_entry.inline_kind = options.inline_kind;
+        }
+        if constexpr (internal::StagingExecutorGeneric<Executor>) {
+            if (options.stage) {
+                // NB: the heap is ordered by the handover timepoint; the job keeps the actual deadline
+                map_entry.stage_deadline = deadline;
+                return insert(deadline - _stage_lookahead, std::move(map_entry));
+            }
+        }
+        return insert(deadline, std::move(map_entry));
+    }
+
+    bool insert(uid_t uid, const Clock::time_point& deadline, MapEntry&& map_entry, const std::stop_token& stop_token = {}) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
+#endif
+
+        bool is_first = false;
+        bool page_in = map_entry.cold;  // NB: not a user timer => not counted
+        typename decltype(_jobs)::node_type evicted;  // NB: destroyed (and thus result slot released) outside the lock
+        {
+            std::lock_guard<Mutex> guard(_lock);
+            if (stop_token.stop_requested()) {  // NB: checked under the lock to synchronize with stop callback
+                return false;
+            }
+            auto job_timer = !map_entry.sleeper && !map_entry.cold;
+            if (_capacity > 0 && job_timer && _job_timers >= _capacity) {
+                evicted = make_room(map_entry.priority);
+                is_first = (_heap[0].uid == evicted.key());
+            }
+            if (job_timer) {
+                ++_job_timers;
+                if (_admission == evict_when_full && _capacity > 0) {
+                    _by_priority.emplace(map_entry.priority, uid);
+                }
+            }
+            _jobs.insert(std::make_pair(uid, std::move(map_entry)));
+            _heap.push_back(HeapEntry {uid, deadline});
+            std::push_heap(_heap.begin(), _heap.end(), TimerQueue::heap_cmp);
+            is_first = is_first || (_heap[0].uid == uid);
+            update_gauges();
+        }
+        if (!page_in) {
+            _enqueued.add();
+        }
+        if (is_first) {
+            _cond.notify_one();
+        }
+        if (evicted) {
+            LOG4CXX_DEBUG(logger, std::format("Evicted timer uid={}", evicted.key()));
+            shed(evicted.mapped(), "Timer evicted from full timer queue");
+        }
+        LOG4CXX_DEBUG(logger, std::format("New timer uid={}", uid));
+        return true;
+    }
+
+    bool cancel_pending(uid_t uid) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
+#endif
+
+        bool was_removed;
+        bool wake;
+        typename decltype(_jobs)::node_type node;  // NB: destroyed (and thus result slot released) outside the lock
+        {
+            std::lock_guard<Mutex> guard(_lock);
+            auto i = _jobs.find(uid);
+            if (i != _jobs.end()) {
+                LOG4CXX_DEBUG(logger, std::format("Canceling timer uid={}", uid));
+                node = _jobs.extract(i);
+                unindex(uid, node.mapped());
+                update_gauges();
+                was_removed = true;
+                wake = (_heap[0].uid == uid) || purge_due();  // NB: the latter => let 'demux()' purge
+            }
+            else {
+                was_removed = false;
+            }
+        }
+        if (was_removed && wake) {
+            _cond.notify_one();
+        }
+        if (was_removed && node.mapped().sleeper) {
+            node.mapped().sleeper->canceled = true;
+            resume(node.mapped().sleeper->handle);
+        }
+        return was_removed;
+    }
+
+    Clock::time_point page_in_time(std::int64_t bucket) const {
+        return typename Clock::time_point(typename Clock::duration(_cold->bucket_start(bucket))) - _cold_horizon;
+    }
+
+    // NB: whether the deadline is too far to keep the timer in memory
+    bool cold(const Clock::time_point& deadline) const {
+        return page_in_time(_cold->bucket(deadline.time_since_epoch().count())) > Clock::now();
+    }
+
+    // NB: put the timer to the cold tier, plus a page-in timer for a new bucket
+    uid_t freeze(const Clock::time_point& deadline, const JobDescriptor& descriptor, int priority, bool staged) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
+#endif
+
+        if (!_job_registry.contains(descriptor.type)) {
+            throw std::out_of_range(std::format("Job type {} is not registered", descriptor.type));
+        }
+        uid_t uid;
+        bool is_new;
+        std::int64_t bucket;
+        {
+            std::lock_guard<Mutex> cold_guard(_cold_lock);
+            uid = _next_uid.fetch_add(1, std::memory_order_relaxed);  // NB: under the lock => uids ascend within a segment
+            internal::ColdRecord record {
+                uid,
+                static_cast<std::int64_t>(deadline.time_since_epoch().count()),
+                priority,
+                staged ? internal::cold_staged : 0,
+                descriptor
+            };
+            is_new = _cold->append(record);
+            bucket = _cold->bucket(record.deadline);
+        }
+        _enqueued.add();
+        if (is_new) {
+            MapEntry map_entry {Executable()};
+            map_entry.cold = true;
+            insert(page_in_time(bucket), std::move(map_entry));
+        }
+        LOG4CXX_DEBUG(logger, std::format("New cold timer uid={}", uid));
+        return uid;
+    }
+
+    // NB: move the timers of the buckets within the horizon from disk to memory
+    void thaw() {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
+#endif
+
+        std::lock_guard<Mutex> cold_guard(_cold_lock);  // NB: held until the timers are in memory, see 'cancel()'
+        auto now = Clock::now();
+        auto records = _cold->take(_cold->bucket((now + _cold_horizon).time_since_epoch().count()));
+        decltype(_jobs) entries;
+        std::vector<HeapEntry> heap_entries;
+        entries.reserve(records.size());
+        heap_entries.reserve(records.size());
+        for (auto&& record: records) {
+            typename Clock::time_point deadline {typename Clock::duration(record.deadline)};
+            try {
+                auto staged = (record.flags & internal::cold_staged);
+                heap_entries.push_back(revive(record.uid, deadline, record.priority, staged, record.descriptor, entries));
+            }
+            catch (const std::exception& exc) {
+                LOG4CXX_ERROR(logger, std::format("Dropping cold timer uid={}: {}", record.uid, exc.what()));
+            }
+        }
+        splice(entries, heap_entries);
+        LOG4CXX_DEBUG(logger, std::format("Paged in {} cold timers", heap_entries.size()));
+    }
+
+    // NB: make the job of a saved timer; the entry goes to 'entries'
+    HeapEntry revive(
+        uid_t uid,
+        const Clock::time_point& deadline,
+        int priority,
+        bool staged,
+        const JobDescriptor& descriptor,
+        decltype(_jobs)& entries
+    ) {
+        MapEntry map_entry {_job_registry.make(descriptor)};
+        map_entry.priority = priority;
+        map_entry.descriptor = std::make_unique<JobDescriptor>(descriptor);
+        auto heap_deadline = deadline;
+        if constexpr (internal::StagingExecutorGeneric<Executor>) {
+            if (staged) {
+                map_entry.stage_deadline = deadline;
+                heap_deadline = deadline - _stage_lookahead;
+            }
+        }
+        entries.emplace(uid, std::move(map_entry));
+        return {uid, heap_deadline};
+    }
+
+    // NB: add timers at once; the map entries are moved node by node
+    void splice(decltype(_jobs)& entries, const std::vector<HeapEntry>& heap_entries) {
+        std::lock_guard<Mutex> guard(_lock);
+        _job_timers += entries.size();  // NB: revived timers are all job timers
+        if (_admission == evict_when_full && _capacity > 0) {
+            for (auto&& [uid, map_entry]: entries) {
+                _by_priority.emplace(map_entry.priority, uid);
+            }
+        }
+        if (_jobs.empty()) {
+            _jobs.swap(entries);
+        }
+        else {
+            _jobs.merge(entries);
+        }
+        if (heap_entries.size() > _heap.size()) {
+            _heap.insert(_heap.end(), heap_entries.begin(), heap_entries.end());
+            std::make_heap(_heap.begin(), _heap.end(), TimerQueue::heap_cmp);  // NB: O(n) rather than n pushes
+        }
+        else {
+            for (auto&& heap_entry: heap_entries) {
+                _heap.push_back(heap_entry);
+                std::push_heap(_heap.begin(), _heap.end(), TimerQueue::heap_cmp);
+            }
+        }
+        update_gauges();
+    }
+
+    // NB: '_lock' must be held; throws if no less important timer can be evicted
+    typename decltype(_jobs)::node_type make_room(int priority) {
+        if (_admission == evict_when_full && !_by_priority.empty() && _by_priority.begin()->first < priority) {
+            auto uid = _by_priority.begin()->second;
+            _by_priority.erase(_by_priority.begin());
+            --_job_timers;
+            _evicted.fetch_add(1, std::memory_order_relaxed);
+            return _jobs.extract(uid);  // NB: the heap entry stays as a canceled timer
+        }
+        _rejected.fetch_add(1, std::memory_order_relaxed);
+        throw std::runtime_error("Timer queue is full");
+    }
+
+    // NB: '_lock' must be held
+    void unindex(uid_t uid, const MapEntry& map_entry) {
+        if (!map_entry.sleeper && !map_entry.cold) {
+            --_job_timers;
+        }
+        if (!_by_priority.empty()) {
+            _by_priority.erase({map_entry.priority, uid});
+        }
+    }
+
+    // NB: a staged timer is handed over early on purpose => it is due at its own deadline, not at the heap one
+    static Clock::time_point due(const MapEntry& map_entry, const Clock::time_point& deadline) {
+        return (map_entry.stage_deadline != typename Clock::time_point()) ? map_entry.stage_deadline : deadline;
+    }
+
+    bool too_late(const MapEntry& map_entry, const Clock::time_point& deadline) const {
+        return _max_lateness > Clock::duration::zero() && !map_entry.sleeper && !map_entry.cold &&
+            map_entry.priority <= _max_shed_priority &&
+            Clock::now() - deadline > _max_lateness;
+    }
+
+    // NB: fail a timer that is not going to be executed
+    static void shed(MapEntry& map_entry, const char* reason) {
+#ifndef YATQ_DISABLE_FUTURES
+        if (map_entry.slot) {
+            map_entry.slot.set_exception(std::make_exception_ptr(std::runtime_error(reason)));
+        }
+#endif
+    }
+
+    void resume(std::coroutine_handle<> handle) {
+        if constexpr (internal::ResumingExecutorGeneric<Executor>) {
+            _executor->resume(handle);
+        }
+        else {
+            handle.resume();  // NB: executor cannot resume coroutines => resume in this thread
+        }
+    }
+
+    static std::chrono::steady_clock::time_point to_steady(const Clock::time_point& time_point) {
+        if constexpr (std::is_same_v<Clock, std::chrono::steady_clock>) {
+            return time_point;
+        }
+        else {
+            return std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(time_point - Clock::now());
+        }
+    }
+
+    void dispatch(MapEntry&& map_entry, const Clock::time_point& deadline) {
+        if (map_entry.sleeper) {
+            resume(map_entry.sleeper->handle);
+            return;
+        }
+        if constexpr (internal::InlineExecutorGeneric<Executor>) {
+            if (map_entry.inline_kind) {
+                // NB: may run the job right here, in the timer queue thread
+#ifndef YATQ_DISABLE_FUTURES
+                _executor->execute_inline(*map_entry.inline_kind, std::move(map_entry.job), std::move(map_entry.slot));
+#else
+                _executor->execute_inline(*map_entry.inline_kind, std::move(map_entry.job));
+#endif
+                return;
+            }
+        }
+        if constexpr (internal::StagingExecutorGeneric<Executor>) {
+            if (map_entry.stage_deadline != typename Clock::time_point()) {
+#ifndef YATQ_DISABLE_FUTURES
+                _executor->stage(std::move(map_entry.job), std::move(map_entry.slot), to_steady(map_entry.stage_deadline));
+#else
+                _executor->stage(std::move(map_entry.job), to_steady(map_entry.stage_deadline));
+#endif
+                return;
+            }
+        }
+        if constexpr (internal::KeyedExecutorGeneric<Executor>) {
+            if (map_entry.key) {
+#ifndef YATQ_DISABLE_FUTURES
+                _executor->execute(*map_entry.key, std::move(map_entry.job), std::move(map_entry.slot));
+#else
+                _executor->execute(*map_entry.key, std::move(map_entry.job));
+#endif
+                return;
+            }
+        }
+        if constexpr (internal::DeadlineExecutorGeneric<Executor>) {
+            // executor orders jobs by timer deadline
+#ifndef YATQ_DISABLE_FUTURES
+            _executor->execute(std::move(map_entry.job), std::move(map_entry.slot), to_steady(deadline));
+#else
+            _executor->execute(std::move(map_entry.job), to_steady(deadline));
+#endif
+            return;
+        }
+        if constexpr (internal::TryExecutorGeneric<Executor>) {
+            // NB: an overloaded executor fails the job rather than stalling the demux thread
+#ifndef YATQ_DISABLE_FUTURES
+            _executor->try_execute(std::move(map_entry.job), std::move(map_entry.slot));
+#else
+            _executor->try_execute(std::move(map_entry.job));
+#endif
+            return;
+        }
+#ifndef YATQ_DISABLE_FUTURES
+        if constexpr (internal::CompletionExecutorGeneric<Executor>) {
+            // executor stores job result straight into the timer slot
+            _executor->execute(std::move(map_entry.job), std::move(map_entry.slot));
+        }
+        else if (!map_entry.slot) {
+            // detached: executor future is discarded
+            _executor->execute(std::move(map_entry.job));
+        }
+        else {
+            // future chaining
+            auto future = _executor->execute(std::move(map_entry.job));
+            internal::FutureChain<typename Executor::Future>::then(
+                future,
+                [slot = std::move(map_entry.slot)]
+                (Executor::Future future) mutable
+                { internal::get_and_complete<result_type>(std::move(future), slot); }
+            );
+        }
+#else
+        _executor->execute(std::move(map_entry.job));
+#endif
+    }
+
     static bool heap_cmp(const HeapEntry& lhs, const HeapEntry& rhs) {
         return lhs.deadline > rhs.deadline;  // NB: '>'
     }
 
+    // NB: '_lock' must be held
+    bool purge_due() const {
+        auto canceled_timers = _heap.size() - _jobs.size();
+        return _purge_ratio > 0 && canceled_timers > 0 && canceled_timers > _purge_ratio * _heap.size();
+    }
+
+    // NB: '_lock' must be held
+    void update_gauges() noexcept {
+        _live_timers.store(_jobs.size(), std::memory_order_relaxed);
+        _heap_size.store(_heap.size(), std::memory_order_relaxed);
+        _heap_capacity.store(_heap.capacity(), std::memory_order_relaxed);
+    }
+
+    // NB: '_lock' must be held; moves the last entry in and restores the heap property around it
+    void erase_at(std::size_t i) {
+        _heap[i] = _heap.back();
+        _heap.pop_back();
+        if (i == _heap.size()) {
+            return;
+        }
+        while (i > 0) {
+            auto parent = (i - 1) / 2;
+            if (!heap_cmp(_heap[parent], _heap[i])) {
+                break;
+            }
+            std::swap(_heap[parent], _heap[i]);
+            i = parent;
+        }
+        for (;;) {
+            auto child = 2 * i + 1;
+            if (child >= _heap.size()) {
+                break;
+            }
+            if (child + 1 < _heap.size() && heap_cmp(_heap[child], _heap[child + 1])) {
+                ++child;
+            }
+            if (!heap_cmp(_heap[i], _heap[child])) {
+                break;
+            }
+            std::swap(_heap[i], _heap[child]);
+            i = child;
+        }
+    }
+
+    // NB: '_lock' must be held; purges one slice walking the heap from its end. the heap stays valid after every
+    // removal => the lock may be released between slices, and timers pushed meanwhile just get checked or not.
+    // 'false' => no purge is due
+    bool purge_slice(std::unique_lock<Mutex>& guard) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
+#endif
+
+        if (_purge_cursor == 0) {
+            if (!purge_due()) {
+                return false;
+            }
+            _purge_cursor = _heap.size();
+            _purged = 0;
+        }
+        for (std::size_t n = 0; n < _purge_slice && _purge_cursor > 0; ++n) {
+            _purge_cursor = std::min(_purge_cursor, _heap.size());
+            if (_purge_cursor == 0) {
+                break;
+            }
+            auto i = --_purge_cursor;
+            if (!_jobs.contains(_heap[i].uid)) {
+                erase_at(i);
+                ++_purged;
+            }
+        }
+        if (_purge_cursor == 0) {
+            LOG4CXX_DEBUG(logger, std::format("Purged {} canceled timers", _purged));
+            shrink(guard);
+        }
+        update_gauges();
+        guard.unlock();
+        std::this_thread::yield();  // NB: let producers blocked on the lock in before the next slice
+        guard.lock();
+        return true;
+    }
+
+    // NB: '_lock' must be held; the new storage is allocated and the old one released outside the lock
+    void shrink(std::unique_lock<Mutex>& guard) {
+        auto size = _heap.size();
+        if (_heap.capacity() <= 2 * size) {
+            return;
+        }
+        std::vector<HeapEntry> heap;
+        guard.unlock();
+        heap.reserve(size + size / 2);  // NB: room for timers added meanwhile
+        guard.lock();
+        if (_heap.size() <= heap.capacity()) {
+            heap.assign(_heap.begin(), _heap.end());
+            _heap.swap(heap);
+            update_gauges();
+        }
+        guard.unlock();
+        heap = {};
+        guard.lock();
+    }
+
     void demux() {
 #ifndef YATQ_DISABLE_LOGGING
         static auto logger = log4cxx::Logger::getLogger("yatq.timer_queue");
@@ -294,7 +1520,7 @@ private:
         SET_THREAD_TAG("timer_queue");
         LOG4CXX_INFO(logger, "Start");
 
-        std::unique_lock<std::mutex> guard(_lock);
+        std::unique_lock<Mutex> guard(_lock);
         while (_running) {
             bool deadline_expired = false;
             while (!_heap.empty()) {
@@ -304,6 +1530,8 @@ private:
                     LOG4CXX_DEBUG(logger, std::format("Timer uid={} has been canceled", current_uid));
                     std::pop_heap(_heap.begin(), _heap.end(), TimerQueue::heap_cmp);
                     _heap.pop_back();
+                    _tombstones.fetch_add(1, std::memory_order_relaxed);
+                    update_gauges();
                     deadline_expired = false;
                     continue;
                 }
@@ -314,39 +1542,58 @@ private:
                 if (deadline_expired) {
                     LOG4CXX_DEBUG(logger, std::format("Executing timer uid={}", current_uid));
                     auto node = _jobs.extract(i);
+                    auto deadline = _heap[0].deadline;
                     std::pop_heap(_heap.begin(), _heap.end(), TimerQueue::heap_cmp);
                     _heap.pop_back();
                     auto map_entry = std::move(node.mapped());
+                    unindex(current_uid, map_entry);
+                    update_gauges();
 
                     guard.unlock();
-#ifndef YATQ_DISABLE_FUTURES
-                    auto future =
-#endif
-                    _executor->execute(std::move(map_entry.job));
+                    if (map_entry.cold) {
+                        thaw();
+                    }
+                    else if (too_late(map_entry, due(map_entry, deadline))) {
+                        LOG4CXX_DEBUG(logger, std::format("Timer uid={} is too late", current_uid));
+                        _late.fetch_add(1, std::memory_order_relaxed);
+                        shed(map_entry, "Timer shed for lateness");
+                        if (_on_late) {
+                            _on_late(current_uid, due(map_entry, deadline));
+                        }
+                    }
+                    else {
+                        auto since = Clock::now() - due(map_entry, deadline);
+                        auto lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(since);
+                        _lateness.record(std::max<std::int64_t>(lateness.count(), 0));
+                        _fired.fetch_add(1, std::memory_order_relaxed);
+                        dispatch(std::move(map_entry), deadline);
+                    }
                     guard.lock();
 
-#ifndef YATQ_DISABLE_FUTURES
-                    future.then(  // future chaining -- this is why we use 'boost::future' instead of 'std::future'
-                        boost::launch::sync,  // FIXME: does not match the concept
-                        [promise = std::move(map_entry.promise)]
-                        (Executor::Future future) mutable
-                        { internal::get_and_set_value<result_type>(std::move(future), std::move(promise)); }
-                    );
-#endif
                     deadline_expired = false;
                 }
+                else if (purge_slice(guard)) {
+                    continue;  // NB: the lock has been released in between => recheck the first timer
+                }
                 else {
                     // NB: without this explicit cast duration type may be deduced incorrectly
                     // on Linux this leads to waiting for a random time point
                     std::chrono::time_point<Clock, typename Clock::duration> deadline = _heap[0].deadline;
                     LOG4CXX_TRACE(logger, std::format("Wait until {}", utils::time_point_to_string(deadline)));
-                    bool notified = _cond.wait_until(
-                            guard,
-                            deadline,
-                            [this, current_uid] () {
-                                return !_jobs.contains(current_uid) || (_heap[0].uid != current_uid) || !_running;
-                            }
-                    );
+                    auto ready = [this, current_uid] () {
+                        return !_jobs.contains(current_uid) || (_heap[0].uid != current_uid) || !_running || purge_due();
+                    };
+                    // NB: 'wait_until()' with a predicate, unrolled to tell wake-ups apart
+                    bool notified = ready();
+                    while (!notified) {
+                        if (_cond.wait_until(guard, deadline) == std::cv_status::timeout) {
+                            notified = ready();
+                            (notified ? _notified_wakeups : _timeout_wakeups).fetch_add(1, std::memory_order_relaxed);
+                            break;
+                        }
+                        notified = ready();
+                        (notified ? _notified_wakeups : _spurious_wakeups).fetch_add(1, std::memory_order_relaxed);
+                    }
                     LOG4CXX_TRACE(logger, "Wake-up");
                     if (!_running) {
                         LOG4CXX_WARN(logger, "Stopping timer queue with unprocessed timers");
@@ -358,7 +1605,11 @@ private:
                 }
             }
             LOG4CXX_TRACE(logger, "Wait");
-            _cond.wait(guard, [this] () { return !_heap.empty() || !_running; });
+            while (_heap.empty() && _running) {
+                _cond.wait(guard);
+                bool notified = !_heap.empty() || !_running;
+                (notified ? _notified_wakeups : _spurious_wakeups).fetch_add(1, std::memory_order_relaxed);
+            }
             LOG4CXX_TRACE(logger, "Wake-up");
         }
 
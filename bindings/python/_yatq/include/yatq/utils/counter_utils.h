@@ -0,0 +1,53 @@
+#ifndef _YATQ_UTILS_COUNTER_UTILS_H
+#define _YATQ_UTILS_COUNTER_UTILS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace yatq::utils {
+
+/**
+ * counter incremented by many threads without contention: each thread adds to its own cache line (one of \a Shards,
+ * assigned round robin on first use), and reading sums them up
+ * @tparam Shards number of shards
+ */
+template<std::size_t Shards = 16>
+class ShardedCounter {
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value {0};
+    };
+
+    Shard _shards[Shards];
+
+public:
+    /**
+     * @param n value to add
+     */
+    void add(std::uint64_t n = 1) noexcept {
+        _shards[shard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return sum of all shards; approximate while the counter is being incremented
+     */
+    std::uint64_t value() const noexcept {
+        std::uint64_t sum = 0;
+        for (auto&& shard: _shards) {
+            sum += shard.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    static std::size_t shard() noexcept {
+        static std::atomic<std::size_t> next_shard {0};
+        thread_local std::size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % Shards;
+        return shard;
+    }
+};
+
+}
+
+#endif
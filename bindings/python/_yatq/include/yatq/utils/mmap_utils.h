@@ -0,0 +1,175 @@
+#ifndef _YATQ_UTILS_MMAP_UTILS_H
+#define _YATQ_UTILS_MMAP_UTILS_H
+
+#include <cerrno>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace yatq::utils {
+
+/**
+ * memory-mapped file, unmapped and closed on destruction
+ */
+class MappedFile {
+private:
+    int _fd;
+    std::byte* _data;
+    std::size_t _size;
+    bool _writable;
+
+public:
+    MappedFile() noexcept: _fd(-1), _data(nullptr), _size(0), _writable(false) {}
+
+    /**
+     * map existing file read-only
+     * @param path file path
+     */
+    explicit MappedFile(const std::string& path): MappedFile() {
+        _fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (_fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        struct stat st;
+        if (::fstat(_fd, &st) != 0) {
+            auto error = errno;
+            close();
+            throw std::system_error(error, std::generic_category(), "fstat " + path);
+        }
+        map(static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, path);
+    }
+
+    /**
+     * create (or truncate) file of the given size and map it read-write
+     * @param path file path
+     * @param size file size
+     */
+    MappedFile(const std::string& path, std::size_t size): MappedFile() {
+        _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (_fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        if (::ftruncate(_fd, static_cast<off_t>(size)) != 0) {
+            auto error = errno;
+            close();
+            throw std::system_error(error, std::generic_category(), "ftruncate " + path);
+        }
+        _writable = true;
+        map(size, PROT_READ | PROT_WRITE, MAP_SHARED, path);
+    }
+
+    MappedFile(MappedFile&& other) noexcept:
+        _fd(std::exchange(other._fd, -1)),
+        _data(std::exchange(other._data, nullptr)),
+        _size(std::exchange(other._size, 0)),
+        _writable(std::exchange(other._writable, false)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            _fd = std::exchange(other._fd, -1);
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+            _writable = std::exchange(other._writable, false);
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    std::byte* data() noexcept {
+        return _data;
+    }
+
+    const std::byte* data() const noexcept {
+        return _data;
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    /**
+     * flush a writable mapping to disk
+     */
+    void sync() {
+        if (_writable && _data && ::msync(_data, _size, MS_SYNC) != 0) {
+            throw std::system_error(errno, std::generic_category(), "msync");
+        }
+    }
+
+    /**
+     * grow or shrink a writable mapping along with the file. the mapping may move
+     * @param size new file size
+     */
+    void resize(std::size_t size) {
+        if (!_writable) {
+            throw std::logic_error("Mapped file is read-only");
+        }
+        if (::ftruncate(_fd, static_cast<off_t>(size)) != 0) {
+            throw std::system_error(errno, std::generic_category(), "ftruncate");
+        }
+        if (_data) {
+            ::munmap(_data, _size);
+            _data = nullptr;
+        }
+        _size = size;
+        if (size == 0) {
+            return;
+        }
+        auto data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if (data == MAP_FAILED) {
+            auto error = errno;
+            close();
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+        _data = static_cast<std::byte*>(data);
+    }
+
+    /**
+     * unmap and close
+     */
+    void close() noexcept {
+        if (_data) {
+            ::munmap(_data, _size);
+            _data = nullptr;
+        }
+        if (_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+        _size = 0;
+        _writable = false;
+    }
+
+private:
+    void map(std::size_t size, int prot, int flags, const std::string& path) {
+        _size = size;
+        if (size == 0) {
+            return;  // NB: an empty file cannot be mapped
+        }
+        auto data = ::mmap(nullptr, size, prot, flags, _fd, 0);
+        if (data == MAP_FAILED) {
+            auto error = errno;
+            close();
+            throw std::system_error(error, std::generic_category(), "mmap " + path);
+        }
+        _data = static_cast<std::byte*>(data);
+    }
+};
+
+}
+
+#endif
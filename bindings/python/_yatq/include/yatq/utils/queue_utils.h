@@ -0,0 +1,598 @@
+#ifndef _YATQ_UTILS_QUEUE_UTILS_H
+#define _YATQ_UTILS_QUEUE_UTILS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "yatq/internal/spin_utils.h"
+
+namespace yatq::utils {
+
+/**
+ * how an idle consumer waits for an element: busy-wait with a pause hint for \a spin iterations, then yield the CPU
+ * for \a yield iterations, then park. a parked consumer costs its producer a wake-up system call and a scheduler
+ * round trip; a spinning one costs CPU time
+ */
+typedef struct {
+    std::size_t spin = 0;
+    std::size_t yield = 0;
+} IdleStrategy;
+
+/**
+ * default job queue policy: \a std::deque guarded by \a Sync::mutex; consumers wait on \a Sync::condition_variable,
+ * after spinning and yielding if so configured (see \a set_idle_strategy()). producers skip the wake-up while a
+ * consumer spins or yields. unbounded unless a capacity is set (see \a set_capacity())
+ */
+struct LockedQueue {
+    template<typename T, typename Sync>
+    class queue {
+    private:
+        using Mutex = Sync::mutex;
+        using ConditionVariable = Sync::condition_variable;
+
+        Mutex _lock;
+        ConditionVariable _cond;
+        ConditionVariable _not_full;
+        std::deque<T> _queue;
+        std::atomic<std::size_t> _size;  // NB: written under the lock, read by spinning consumers
+        std::atomic<std::size_t> _spinning;
+        std::atomic<std::size_t> _sleeping;  // NB: written under the lock
+        std::atomic<std::size_t> _spin;
+        std::atomic<std::size_t> _yield;
+        std::size_t _capacity;  // NB: guarded by the lock; 0 => unbounded
+        std::size_t _blocked;  // NB: producers waiting for room, guarded by the lock
+
+        // NB: '_lock' must be held
+        bool full() const {
+            return _capacity > 0 && _queue.size() >= _capacity;
+        }
+
+        // NB: '_lock' must be held
+        void take(T& value) {
+            value = std::move(_queue.front());
+            _queue.pop_front();
+            _size.store(_queue.size(), std::memory_order_relaxed);
+            if (_blocked > 0) {
+                _not_full.notify_one();
+            }
+        }
+
+        // NB: '_lock' must be held; returns the new size
+        std::size_t put(T&& value) {
+            _queue.push_back(std::move(value));
+            auto size = _queue.size();
+            _size.store(size, std::memory_order_relaxed);
+            return size;
+        }
+
+        void notify(std::size_t size) {
+            // NB: spinning consumers will find the elements => no system call unless there are more elements
+            if (_sleeping.load(std::memory_order_relaxed) > 0 && size > _spinning.load(std::memory_order_relaxed)) {
+                _cond.notify_one();
+            }
+        }
+
+        // NB: '_lock' must be held; a consumer leaving the spin phase goes to sleep in the same critical section
+        // => a producer either sees it spinning (and it will find the element) or sleeping
+        template<typename Wait>
+        void park(bool spun, Wait&& wait) {
+            if (spun) {
+                _spinning.fetch_sub(1, std::memory_order_relaxed);
+            }
+            _sleeping.fetch_add(1, std::memory_order_relaxed);
+            wait();
+            _sleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // NB: 'true' => an element may be available
+        bool spin(const std::atomic<bool>& running) {
+            auto spin = _spin.load(std::memory_order_relaxed);
+            auto yield = _yield.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < spin + yield; ++i) {
+                if (_size.load(std::memory_order_relaxed) > 0 || !running.load(std::memory_order_relaxed)) {
+                    return true;
+                }
+                if (i < spin) {
+                    internal::cpu_relax();
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+            return false;
+        }
+
+    public:
+        queue(): _size(0), _spinning(0), _sleeping(0), _spin(0), _yield(0), _capacity(0), _blocked(0) {}
+
+        /**
+         * set idle consumer behaviour. parks right away by default
+         * @param idle_strategy idle strategy
+         */
+        void set_idle_strategy(const IdleStrategy& idle_strategy) {
+            _spin.store(idle_strategy.spin, std::memory_order_relaxed);
+            _yield.store(idle_strategy.yield, std::memory_order_relaxed);
+        }
+
+        /**
+         * bound the queue. producers blocked in \a push() recheck on the next \a pop()
+         * @param capacity max number of elements; 0 => unbounded (default)
+         */
+        void set_capacity(std::size_t capacity) {
+            {
+                std::lock_guard<Mutex> guard(_lock);
+                _capacity = capacity;
+            }
+            _not_full.notify_all();
+        }
+
+        /**
+         * block while the queue is full
+         */
+        void push(T&& value) {
+            std::size_t size;
+            {
+                std::unique_lock<Mutex> guard(_lock);
+                if (full()) {
+                    ++_blocked;
+                    _not_full.wait(guard, [this] () { return !full(); });
+                    --_blocked;
+                }
+                size = put(std::move(value));
+            }
+            notify(size);
+        }
+
+        /**
+         * @return \a false if the queue is full; \a value is left intact then
+         */
+        bool try_push(T&& value) {
+            std::size_t size;
+            {
+                std::lock_guard<Mutex> guard(_lock);
+                if (full()) {
+                    return false;
+                }
+                size = put(std::move(value));
+            }
+            notify(size);
+            return true;
+        }
+
+        /**
+         * push regardless of the capacity, i.e. never block
+         */
+        void force_push(T&& value) {
+            std::size_t size;
+            {
+                std::lock_guard<Mutex> guard(_lock);
+                size = put(std::move(value));
+            }
+            notify(size);
+        }
+
+        bool try_pop(T& value) {
+            std::lock_guard<Mutex> guard(_lock);
+            if (_queue.empty()) {
+                return false;
+            }
+            take(value);
+            return true;
+        }
+
+        /**
+         * block until an element is available or \a running turns \a false
+         * @return \a false if stopped
+         */
+        bool pop(T& value, const std::atomic<bool>& running) {
+            auto ready = [this, &running] () { return !_queue.empty() || !running; };
+            bool spun = false;
+            if (_spin.load(std::memory_order_relaxed) + _yield.load(std::memory_order_relaxed) > 0) {
+                _spinning.fetch_add(1, std::memory_order_relaxed);
+                spun = true;
+                while (spin(running)) {
+                    std::lock_guard<Mutex> guard(_lock);
+                    if (ready()) {
+                        _spinning.fetch_sub(1, std::memory_order_relaxed);
+                        if (!running) {
+                            return false;
+                        }
+                        take(value);
+                        return true;
+                    }
+                }
+            }
+            std::unique_lock<Mutex> guard(_lock);
+            park(spun, [this, &guard, &ready] () { _cond.wait(guard, ready); });
+            if (!running) {
+                return false;
+            }
+            take(value);
+            return true;
+        }
+
+        /**
+         * block until an element is available, \a running turns \a false or the deadline expires. parks right away
+         * @return \a false if stopped or timed out
+         */
+        bool pop(T& value, const std::atomic<bool>& running, const std::chrono::steady_clock::time_point& deadline) {
+            auto ready = [this, &running] () { return !_queue.empty() || !running; };
+            bool available;
+            std::unique_lock<Mutex> guard(_lock);
+            park(false, [this, &guard, &deadline, &ready, &available] () { available = _cond.wait_until(guard, deadline, ready); });
+            if (!available || !running) {
+                return false;
+            }
+            take(value);
+            return true;
+        }
+
+        /**
+         * @return number of elements. lock-free, approximate under contention
+         */
+        std::size_t size() const noexcept {
+            return _size.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * inspect the element at the head of the queue, i.e. the oldest one, under the lock
+         * @param f callable taking \a const \a T&
+         * @return \a false if the queue is empty
+         */
+        template<typename F>
+        bool peek(F&& f) {
+            std::lock_guard<Mutex> guard(_lock);
+            if (_queue.empty()) {
+                return false;
+            }
+            f(static_cast<const T&>(_queue.front()));
+            return true;
+        }
+
+        /**
+         * wake all consumers blocked in \a pop() so that they recheck \a running
+         */
+        void wake_all() {
+            { std::lock_guard<Mutex> guard(_lock); }
+            _cond.notify_all();
+        }
+    };
+};
+
+/**
+ * earliest deadline first job queue policy: binary heap guarded by \a Sync::mutex, ordered by the \a deadline member
+ * of the elements (FIFO among equal deadlines and for elements without one); consumers wait on
+ * \a Sync::condition_variable. \a push() and \a pop() are O(log n)
+ */
+struct DeadlineQueue {
+    static constexpr bool earliest_deadline_first = true;
+
+    template<typename T, typename Sync>
+    class queue {
+    private:
+        using Mutex = Sync::mutex;
+        using ConditionVariable = Sync::condition_variable;
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        typedef struct {
+            TimePoint deadline;
+            std::uint64_t seq;
+            T value;
+        } HeapEntry;
+
+        Mutex _lock;
+        ConditionVariable _cond;
+        std::vector<HeapEntry> _heap;
+        std::uint64_t _next_seq = 0;
+        std::atomic<std::size_t> _size {0};  // NB: written under the lock
+
+        static TimePoint deadline_of(const T& value) {
+            if constexpr (requires { { value.deadline } -> std::convertible_to<TimePoint>; }) {
+                return value.deadline;
+            }
+            else {
+                return TimePoint();
+            }
+        }
+
+        static bool heap_cmp(const HeapEntry& lhs, const HeapEntry& rhs) {
+            // NB: '>' => min-heap
+            return lhs.deadline > rhs.deadline || (lhs.deadline == rhs.deadline && lhs.seq > rhs.seq);
+        }
+
+        // NB: '_lock' must be held
+        void take(T& value) {
+            std::pop_heap(_heap.begin(), _heap.end(), queue::heap_cmp);
+            value = std::move(_heap.back().value);
+            _heap.pop_back();
+            _size.store(_heap.size(), std::memory_order_relaxed);
+        }
+
+    public:
+        void push(T&& value) {
+            {
+                std::lock_guard<Mutex> guard(_lock);
+                auto deadline = deadline_of(value);
+                _heap.push_back(HeapEntry {deadline, _next_seq++, std::move(value)});
+                std::push_heap(_heap.begin(), _heap.end(), queue::heap_cmp);
+                _size.store(_heap.size(), std::memory_order_relaxed);
+            }
+            _cond.notify_one();
+        }
+
+        /**
+         * @return always \a true: unbounded
+         */
+        bool try_push(T&& value) {
+            push(std::move(value));
+            return true;
+        }
+
+        /**
+         * same as \a push(): unbounded
+         */
+        void force_push(T&& value) {
+            push(std::move(value));
+        }
+
+        bool try_pop(T& value) {
+            std::lock_guard<Mutex> guard(_lock);
+            if (_heap.empty()) {
+                return false;
+            }
+            take(value);
+            return true;
+        }
+
+        /**
+         * block until an element is available or \a running turns \a false
+         * @return \a false if stopped
+         */
+        bool pop(T& value, const std::atomic<bool>& running) {
+            std::unique_lock<Mutex> guard(_lock);
+            _cond.wait(guard, [this, &running] () { return !_heap.empty() || !running; });
+            if (!running) {
+                return false;
+            }
+            take(value);
+            return true;
+        }
+
+        /**
+         * block until an element is available, \a running turns \a false or the deadline expires
+         * @return \a false if stopped or timed out
+         */
+        bool pop(T& value, const std::atomic<bool>& running, const TimePoint& deadline) {
+            std::unique_lock<Mutex> guard(_lock);
+            auto ready = _cond.wait_until(guard, deadline, [this, &running] () { return !_heap.empty() || !running; });
+            if (!ready || !running) {
+                return false;
+            }
+            take(value);
+            return true;
+        }
+
+        /**
+         * @return number of elements. lock-free, approximate under contention
+         */
+        std::size_t size() const noexcept {
+            return _size.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * wake all consumers blocked in \a pop() so that they recheck \a running
+         */
+        void wake_all() {
+            { std::lock_guard<Mutex> guard(_lock); }
+            _cond.notify_all();
+        }
+    };
+};
+
+/**
+ * bounded lock-free job queue policy: multi-producer multi-consumer ring buffer with per-cell sequence counters
+ * (D. Vyukov). consumers spin briefly and then park on an event count (\a std::atomic::wait), so neither \a push() nor
+ * \a pop() take a lock and \a push() makes no system call unless a consumer is parked. a producer facing a full ring
+ * yields until there is room; \a force_push() spills into a locked overflow list instead. \a Sync is not used
+ * @tparam Capacity ring size; power of 2
+ */
+template<std::size_t Capacity = 4096>
+struct RingQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+    template<typename T, typename Sync>
+    class queue {
+    private:
+        static constexpr std::size_t cache_line = 64;
+        static constexpr int spin_count = 128;
+
+        struct Cell {
+            std::atomic<std::size_t> sequence;
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        std::unique_ptr<Cell[]> _cells;
+        alignas(cache_line) std::atomic<std::size_t> _enqueue_pos;
+        alignas(cache_line) std::atomic<std::size_t> _dequeue_pos;
+        alignas(cache_line) std::atomic<std::uint32_t> _epoch;
+        std::atomic<std::uint32_t> _waiters;
+        alignas(cache_line) std::atomic<std::size_t> _overflow_size;
+        std::mutex _overflow_lock;
+        std::deque<T> _overflow;  // NB: elements forced into a full ring, guarded by '_overflow_lock'
+
+    public:
+        queue(): _cells(new Cell[Capacity]), _enqueue_pos(0), _dequeue_pos(0), _epoch(0), _waiters(0), _overflow_size(0) {
+            for (std::size_t i = 0; i < Capacity; ++i) {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        queue(const queue&) = delete;
+        queue& operator=(const queue&) = delete;
+
+        ~queue() {
+            T value;
+            while (try_pop(value)) {}
+        }
+
+        void push(T&& value) {
+            while (!enqueue(value)) {
+                std::this_thread::yield();  // NB: full
+            }
+            notify();
+        }
+
+        /**
+         * @return \a false if the ring is full; \a value is left intact then
+         */
+        bool try_push(T&& value) {
+            if (!enqueue(value)) {
+                return false;
+            }
+            notify();
+            return true;
+        }
+
+        /**
+         * push even if the ring is full, i.e. never block: the element goes to a locked overflow list then
+         */
+        void force_push(T&& value) {
+            if (!enqueue(value)) {
+                std::lock_guard<std::mutex> guard(_overflow_lock);
+                _overflow.push_back(std::move(value));
+                _overflow_size.store(_overflow.size(), std::memory_order_release);
+            }
+            notify();
+        }
+
+        bool try_pop(T& value) {
+            auto pos = _dequeue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& cell = _cells[pos & (Capacity - 1)];
+                auto sequence = cell.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+                if (diff == 0) {
+                    if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        auto element = std::launder(reinterpret_cast<T*>(cell.storage));
+                        value = std::move(*element);
+                        element->~T();
+                        cell.sequence.store(pos + Capacity, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return take_overflow(value);
+                }
+                else {
+                    pos = _dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * block until an element is available or \a running turns \a false
+         * @return \a false if stopped
+         */
+        bool pop(T& value, const std::atomic<bool>& running) {
+            for (int i = 0; i < spin_count; ++i) {
+                if (try_pop(value)) {
+                    return true;
+                }
+            }
+            for (;;) {
+                if (!running.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                auto epoch = _epoch.load(std::memory_order_acquire);
+                _waiters.fetch_add(1, std::memory_order_seq_cst);
+                if (try_pop(value)) {
+                    _waiters.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+                if (running.load(std::memory_order_acquire)) {
+                    _epoch.wait(epoch, std::memory_order_acquire);  // NB: returns right away if 'push()' got ahead
+                }
+                _waiters.fetch_sub(1, std::memory_order_relaxed);
+                if (try_pop(value)) {
+                    return true;
+                }
+            }
+        }
+
+        /**
+         * @return number of elements, counting those being pushed. lock-free, approximate under contention
+         */
+        std::size_t size() const noexcept {
+            auto dequeue_pos = _dequeue_pos.load(std::memory_order_relaxed);
+            auto ring_size = _enqueue_pos.load(std::memory_order_relaxed) - dequeue_pos;  // NB: both only grow => no underflow
+            return ring_size + _overflow_size.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * wake all consumers blocked in \a pop() so that they recheck \a running
+         */
+        void wake_all() {
+            _epoch.fetch_add(1, std::memory_order_release);
+            _epoch.notify_all();
+        }
+
+    private:
+        bool take_overflow(T& value) {
+            if (_overflow_size.load(std::memory_order_acquire) == 0) {
+                return false;
+            }
+            std::lock_guard<std::mutex> guard(_overflow_lock);
+            if (_overflow.empty()) {
+                return false;
+            }
+            value = std::move(_overflow.front());
+            _overflow.pop_front();
+            _overflow_size.store(_overflow.size(), std::memory_order_relaxed);
+            return true;
+        }
+
+        bool enqueue(T& value) {
+            auto pos = _enqueue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& cell = _cells[pos & (Capacity - 1)];
+                auto sequence = cell.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0) {
+                    if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        ::new (static_cast<void*>(cell.storage)) T(std::move(value));
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = _enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void notify() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);  // NB: pairs with 'fetch_add()' on '_waiters'
+            if (_waiters.load(std::memory_order_relaxed) > 0) {
+                _epoch.fetch_add(1, std::memory_order_release);
+                _epoch.notify_one();
+            }
+        }
+    };
+};
+
+}
+
+#endif
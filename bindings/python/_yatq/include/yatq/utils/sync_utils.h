@@ -0,0 +1,175 @@
+#ifndef _YATQ_UTILS_SYNC_UTILS_H
+#define _YATQ_UTILS_SYNC_UTILS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <ctime>
+#include <mutex>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#ifndef YATQ_DISABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+namespace yatq::utils {
+
+/**
+ * default synchronization primitives: \a std::mutex and \a std::condition_variable
+ */
+struct StdSync {
+    using mutex = std::mutex;
+    using condition_variable = std::condition_variable;
+};
+
+#ifndef YATQ_DISABLE_PTHREAD
+/**
+ * mutex with priority inheritance protocol (\a PTHREAD_PRIO_INHERIT): a thread holding the mutex runs with the highest
+ * priority among the threads blocked on it. meets \a Lockable requirements
+ */
+class PrioInheritMutex {
+private:
+    pthread_mutex_t _mutex;
+
+public:
+    using native_handle_type = pthread_mutex_t*;
+
+    PrioInheritMutex() {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        int error = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+        if (error == 0) {
+            error = pthread_mutex_init(&_mutex, &attr);
+        }
+        pthread_mutexattr_destroy(&attr);
+        if (error != 0) {
+            throw std::system_error(error, std::system_category(), "pthread_mutex_init");
+        }
+    }
+
+    PrioInheritMutex(const PrioInheritMutex&) = delete;
+    PrioInheritMutex& operator=(const PrioInheritMutex&) = delete;
+
+    ~PrioInheritMutex() {
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    void lock() {
+        int error = pthread_mutex_lock(&_mutex);
+        if (error != 0) {
+            throw std::system_error(error, std::system_category(), "pthread_mutex_lock");
+        }
+    }
+
+    bool try_lock() {
+        return pthread_mutex_trylock(&_mutex) == 0;
+    }
+
+    void unlock() {
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    native_handle_type native_handle() {
+        return &_mutex;
+    }
+};
+
+/**
+ * condition variable to be used with \a PrioInheritMutex. mimics \a std::condition_variable interface
+ */
+class PrioInheritConditionVariable {
+private:
+    pthread_cond_t _cond;
+
+public:
+    using native_handle_type = pthread_cond_t*;
+
+    PrioInheritConditionVariable() {
+        int error = pthread_cond_init(&_cond, nullptr);
+        if (error != 0) {
+            throw std::system_error(error, std::system_category(), "pthread_cond_init");
+        }
+    }
+
+    PrioInheritConditionVariable(const PrioInheritConditionVariable&) = delete;
+    PrioInheritConditionVariable& operator=(const PrioInheritConditionVariable&) = delete;
+
+    ~PrioInheritConditionVariable() {
+        pthread_cond_destroy(&_cond);
+    }
+
+    void notify_one() noexcept {
+        pthread_cond_signal(&_cond);
+    }
+
+    void notify_all() noexcept {
+        pthread_cond_broadcast(&_cond);
+    }
+
+    void wait(std::unique_lock<PrioInheritMutex>& lock) {
+        pthread_cond_wait(&_cond, lock.mutex()->native_handle());
+    }
+
+    template<typename Predicate>
+    void wait(std::unique_lock<PrioInheritMutex>& lock, Predicate pred) {
+        while (!pred()) {
+            wait(lock);
+        }
+    }
+
+    template<typename Clock, typename Duration>
+    std::cv_status wait_until(std::unique_lock<PrioInheritMutex>& lock, const std::chrono::time_point<Clock, Duration>& t) {
+        // NB: 'pthread_cond_timedwait()' measures against 'CLOCK_REALTIME'; other clocks are converted through delta
+        std::chrono::system_clock::time_point abs_time;
+        if constexpr (std::is_same_v<Clock, std::chrono::system_clock>) {
+            abs_time = std::chrono::time_point_cast<std::chrono::system_clock::duration>(t);
+        }
+        else {
+            abs_time = std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(t - Clock::now());
+        }
+        auto since_epoch = abs_time.time_since_epoch();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds);
+        timespec ts {static_cast<std::time_t>(seconds.count()), static_cast<long>(nanoseconds.count())};
+        int error = pthread_cond_timedwait(&_cond, lock.mutex()->native_handle(), &ts);
+        if (error == ETIMEDOUT) {
+            return (Clock::now() < t) ? std::cv_status::no_timeout : std::cv_status::timeout;
+        }
+        return std::cv_status::no_timeout;
+    }
+
+    template<typename Clock, typename Duration, typename Predicate>
+    bool wait_until(std::unique_lock<PrioInheritMutex>& lock, const std::chrono::time_point<Clock, Duration>& t, Predicate pred) {
+        while (!pred()) {
+            if (wait_until(lock, t) == std::cv_status::timeout) {
+                return pred();
+            }
+        }
+        return true;
+    }
+
+    template<typename Rep, typename Period, typename Predicate>
+    bool wait_for(std::unique_lock<PrioInheritMutex>& lock, const std::chrono::duration<Rep, Period>& timeout, Predicate pred) {
+        return wait_until(lock, std::chrono::steady_clock::now() + timeout, std::move(pred));
+    }
+
+    native_handle_type native_handle() {
+        return &_cond;
+    }
+};
+
+/**
+ * priority inheritance synchronization primitives. use these to avoid priority inversion when the timer queue thread
+ * runs with real-time scheduling policy while producers do not
+ */
+struct PrioInheritSync {
+    using mutex = PrioInheritMutex;
+    using condition_variable = PrioInheritConditionVariable;
+};
+#endif
+
+}
+
+#endif
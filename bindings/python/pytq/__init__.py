@@ -1,5 +1,12 @@
-from _yatq import __version__, TimerQueue, TimerHandle, ThreadPool, utils
+from _yatq import (
+    __version__, TimerQueue, TimerHandle, ShedStats, TimerQueueStats, HistogramSummary, admission_policy_t, ThreadPool,
+    OverflowStats, ThreadPoolStats, WorkerStats, overflow_policy_t, submit_status_t, utils
+)
 from .pythonize import pythonize
 
 
-__all__ = ['__version__', 'TimerQueue', 'TimerHandle', 'ThreadPool', 'utils', 'pythonize']
+__all__ = [
+    '__version__', 'TimerQueue', 'TimerHandle', 'ShedStats', 'TimerQueueStats', 'HistogramSummary', 'admission_policy_t',
+    'ThreadPool', 'OverflowStats', 'ThreadPoolStats', 'WorkerStats', 'overflow_policy_t', 'submit_status_t', 'utils',
+    'pythonize'
+]
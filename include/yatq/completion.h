@@ -0,0 +1,443 @@
+#ifndef _YATQ_COMPLETION_H
+#define _YATQ_COMPLETION_H
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "yatq/move_only_function.h"
+#include "yatq/utils/sync_utils.h"
+
+namespace yatq {
+
+template<typename T>
+class CompletionHandle;
+
+template<typename T>
+class CompletionSlot;
+
+template<typename T, typename Sync>
+class CompletionPool;
+
+namespace internal {
+
+template<typename T>
+class CompletionPoolCore;
+
+/**
+ * shared state of a single completion: result slot, continuation and intrusive reference counter
+ */
+template<typename T>
+class CompletionState {
+public:
+    using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+    using Continuation = MoveOnlyFunction<void(CompletionHandle<T>)>;
+
+    static constexpr std::uint32_t READY = 1;
+    static constexpr std::uint32_t CONTINUATION = 2;
+    static constexpr std::uint32_t WAITING = 4;
+
+    std::atomic<std::uint32_t> refs;
+    std::atomic<std::uint32_t> status;
+    std::optional<Value> value;
+    std::exception_ptr exception;
+    Continuation continuation;
+    CompletionPoolCore<T>* pool;
+    CompletionState* next;  // NB: free list link
+
+    explicit CompletionState(CompletionPoolCore<T>* pool): refs(0), status(0), pool(pool), next(nullptr) {}
+
+    void add_ref() noexcept {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() noexcept;
+
+    void complete() {
+        auto prev = status.fetch_or(READY, std::memory_order_acq_rel);
+        if (prev & WAITING) {
+            status.notify_all();
+        }
+        if (prev & CONTINUATION) {
+            run_continuation();
+        }
+    }
+
+    void complete_and_release() {
+        complete();
+        release();
+    }
+
+    void set_continuation(Continuation&& func) {
+        continuation = std::move(func);
+        auto prev = status.fetch_or(CONTINUATION, std::memory_order_acq_rel);
+        if (prev & READY) {
+            run_continuation();
+        }
+    }
+
+    void wait() {
+        auto current = status.load(std::memory_order_acquire);
+        while (!(current & READY)) {
+            if (!(current & WAITING)) {
+                current = status.fetch_or(WAITING, std::memory_order_acq_rel) | WAITING;
+                continue;
+            }
+            status.wait(current, std::memory_order_acquire);
+            current = status.load(std::memory_order_acquire);
+        }
+    }
+
+    bool is_ready() const noexcept {
+        return status.load(std::memory_order_acquire) & READY;
+    }
+
+    // NB: only meaningful for the writer; a state referenced by the slot alone and without continuation is unobservable
+    bool is_observed() const noexcept {
+        return refs.load(std::memory_order_acquire) > 1 || (status.load(std::memory_order_acquire) & CONTINUATION);
+    }
+
+private:
+    void run_continuation();
+};
+
+/**
+ * free list of completion states. outlives the pool object as long as any of its states is in use. the lock type is
+ * erased so that states, slots and handles do not depend on it
+ */
+template<typename T>
+class CompletionPoolCore {
+protected:
+    CompletionState<T>* _free;
+    std::atomic<std::size_t> _refs;
+
+public:
+    CompletionPoolCore(): _free(nullptr), _refs(1) {}
+
+    CompletionPoolCore(const CompletionPoolCore&) = delete;
+    CompletionPoolCore& operator=(const CompletionPoolCore&) = delete;
+
+    virtual ~CompletionPoolCore() {
+        while (_free) {
+            auto state = _free;
+            _free = state->next;
+            delete state;
+        }
+    }
+
+    virtual void recycle(CompletionState<T>* state) noexcept = 0;
+
+    void release() noexcept {
+        if (_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+};
+
+// NB: the free list lock is 'Sync::mutex' => e.g. a real-time thread making slots gets priority inheritance
+template<typename T, typename Sync>
+class LockedCompletionPoolCore final: public CompletionPoolCore<T> {
+private:
+    using Mutex = Sync::mutex;
+
+    Mutex _lock;
+
+public:
+    CompletionState<T>* acquire() {
+        this->_refs.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<Mutex> guard(_lock);
+            if (this->_free) {
+                auto state = this->_free;
+                this->_free = state->next;
+                return state;
+            }
+        }
+        return new CompletionState<T>(this);
+    }
+
+    void recycle(CompletionState<T>* state) noexcept override {
+        {
+            std::lock_guard<Mutex> guard(_lock);
+            state->next = this->_free;
+            this->_free = state;
+        }
+        this->release();
+    }
+};
+
+template<typename T>
+void CompletionState<T>::release() noexcept {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        value.reset();
+        exception = nullptr;
+        continuation = nullptr;
+        status.store(0, std::memory_order_relaxed);
+        if (pool) {
+            pool->recycle(this);
+        }
+        else {
+            delete this;
+        }
+    }
+}
+
+template<typename T>
+void CompletionState<T>::run_continuation() {
+    add_ref();
+    auto func = std::move(continuation);
+    func(CompletionHandle<T>(this));
+}
+
+}
+
+/**
+ * read side of a completion: a lightweight future. \a get() may be called once
+ */
+template<typename T>
+class CompletionHandle {
+private:
+    using State = internal::CompletionState<T>;
+
+    State* _state;
+
+    template<typename, typename>
+    friend class CompletionPool;
+    friend class internal::CompletionState<T>;
+
+    explicit CompletionHandle(State* state) noexcept: _state(state) {}
+
+public:
+    using Continuation = typename State::Continuation;  // NB: \a then() moves it into the state as is => no allocation
+
+    /**
+     * create empty (invalid) handle
+     */
+    CompletionHandle() noexcept: _state(nullptr) {}
+
+    CompletionHandle(CompletionHandle&& other) noexcept: _state(std::exchange(other._state, nullptr)) {}
+
+    CompletionHandle& operator=(CompletionHandle&& other) noexcept {
+        if (this != &other) {
+            reset();
+            _state = std::exchange(other._state, nullptr);
+        }
+        return *this;
+    }
+
+    CompletionHandle(const CompletionHandle&) = delete;
+    CompletionHandle& operator=(const CompletionHandle&) = delete;
+
+    ~CompletionHandle() {
+        reset();
+    }
+
+    /**
+     * check whether the handle refers to a completion
+     */
+    bool valid() const noexcept {
+        return _state != nullptr;
+    }
+
+    /**
+     * check whether the result is available
+     */
+    bool is_ready() const noexcept {
+        return _state->is_ready();
+    }
+
+    /**
+     * block until the result is available
+     */
+    void wait() const {
+        _state->wait();
+    }
+
+    /**
+     * block until the result is available and obtain it
+     * @return job return value
+     * @throw job exception
+     */
+    T get() {
+        _state->wait();
+        if (_state->exception) {
+            std::rethrow_exception(_state->exception);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*_state->value);
+        }
+    }
+
+    /**
+     * attach continuation. continuation is called with a handle to the same completion, either in the thread setting
+     * the result or right away if the result is already available. the handle itself becomes invalid
+     * @param func continuation; \a void(CompletionHandle<T>)
+     */
+    template<typename F>
+    void then(F&& func) {
+        auto state = std::exchange(_state, nullptr);
+        state->set_continuation(typename State::Continuation(std::forward<F>(func)));
+        state->release();
+    }
+
+private:
+    void reset() noexcept {
+        if (_state) {
+            std::exchange(_state, nullptr)->release();
+        }
+    }
+};
+
+/**
+ * write side of a completion: a lightweight promise. an unset slot breaks the promise upon destruction. an empty slot
+ * (default constructed) discards the result
+ */
+template<typename T>
+class CompletionSlot {
+private:
+    using State = internal::CompletionState<T>;
+
+    State* _state;
+
+    template<typename, typename>
+    friend class CompletionPool;
+
+    explicit CompletionSlot(State* state) noexcept: _state(state) {}
+
+public:
+    /**
+     * create empty slot
+     */
+    CompletionSlot() noexcept: _state(nullptr) {}
+
+    CompletionSlot(CompletionSlot&& other) noexcept: _state(std::exchange(other._state, nullptr)) {}
+
+    CompletionSlot& operator=(CompletionSlot&& other) noexcept {
+        if (this != &other) {
+            reset();
+            _state = std::exchange(other._state, nullptr);
+        }
+        return *this;
+    }
+
+    CompletionSlot(const CompletionSlot&) = delete;
+    CompletionSlot& operator=(const CompletionSlot&) = delete;
+
+    ~CompletionSlot() {
+        reset();
+    }
+
+    /**
+     * check whether the slot refers to a completion
+     */
+    explicit operator bool() const noexcept {
+        return _state != nullptr;
+    }
+
+    /**
+     * store result
+     * @param value job return value
+     */
+    template<typename... Args>
+    void set_value(Args&&... args) {
+        _state->value.emplace(std::forward<Args>(args)...);
+        std::exchange(_state, nullptr)->complete_and_release();
+    }
+
+    /**
+     * store exception
+     * @param exception job exception
+     */
+    void set_exception(std::exception_ptr exception) {
+        _state->exception = std::move(exception);
+        std::exchange(_state, nullptr)->complete_and_release();
+    }
+
+private:
+    void reset() noexcept {
+        if (_state) {
+            if (_state->is_observed()) {
+                set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            }
+            else {
+                std::exchange(_state, nullptr)->release();
+            }
+        }
+    }
+};
+
+/**
+ * pool of recycled completion states. a state returns to the pool when both its slot and its handle are gone; it is
+ * safe to destroy the pool while some of them are still in use
+ * @tparam Sync synchronization primitives guarding the free list, e.g. \a yatq::utils::PrioInheritSync
+ */
+template<typename T, typename Sync = utils::StdSync>
+class CompletionPool {
+private:
+    internal::LockedCompletionPoolCore<T, Sync>* _core;
+
+public:
+    CompletionPool(): _core(new internal::LockedCompletionPoolCore<T, Sync>) {}
+
+    CompletionPool(const CompletionPool&) = delete;
+    CompletionPool& operator=(const CompletionPool&) = delete;
+
+    ~CompletionPool() {
+        _core->release();
+    }
+
+    /**
+     * create a connected slot and handle
+     */
+    std::pair<CompletionSlot<T>, CompletionHandle<T>> make() {
+        auto state = _core->acquire();
+        state->refs.store(2, std::memory_order_relaxed);
+        return {CompletionSlot<T>(state), CompletionHandle<T>(state)};
+    }
+};
+
+namespace internal {
+
+template<typename result_type, typename Job>
+void run_and_complete(Job&& job, CompletionSlot<result_type>& slot) {
+    try {
+        if constexpr (std::is_void_v<result_type>) {
+            job();
+            slot.set_value();
+        }
+        else {
+            slot.set_value(job());
+        }
+    }
+    catch (...) {
+        slot.set_exception(std::current_exception());
+    }
+}
+
+template<typename result_type, typename Future>
+void get_and_complete(Future&& future, CompletionSlot<result_type>& slot) {
+    try {
+        if constexpr (std::is_void_v<result_type>) {
+            future.get();
+            slot.set_value();
+        }
+        else {
+            slot.set_value(future.get());
+        }
+    }
+    catch (...) {
+        slot.set_exception(std::current_exception());
+    }
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef _YATQ_HYBRID_EXECUTOR_H
+#define _YATQ_HYBRID_EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <format>
+#include <stdexcept>
+
+#include "yatq/internal/concepts.h"
+#include "yatq/internal/log4cxx_proxy.h"
+#ifndef YATQ_DISABLE_FUTURES
+#include "yatq/completion.h"
+#endif
+#include "yatq/thread_pool.h"
+
+namespace yatq {
+
+using internal::ExecutorGeneric;
+
+/**
+ * executor running cheap jobs inline in the calling thread, typically the timer queue thread, and everything else in a
+ * backing executor. jobs are marked cheap by kind: a kind with a budget (see \a set_budget()) runs inline as long as
+ * none of its jobs has run longer than the budget; the first overrun demotes the kind, i.e. its further jobs go to the
+ * backing executor, so one slow callback cannot delay every later timer. \a TimerQueue passes
+ * \a TimerOptions::inline_kind along
+ * @tparam MaxKinds number of job kinds
+ */
+template<ExecutorGeneric _Executor = ThreadPool<>, std::size_t MaxKinds = 64>
+class HybridExecutor {
+#ifndef YATQ_DISABLE_FUTURES
+    static_assert(internal::CompletionExecutorGeneric<_Executor>, "Backing executor must accept completion slots");
+#endif
+
+public:
+    using Executor = _Executor;
+    using Executable = Executor::Executable;
+    using result_type = internal::executable_result_t<Executable>;
+#ifndef YATQ_DISABLE_FUTURES
+    using Future = Executor::Future;
+    using Slot = Executor::Slot;
+#endif
+
+    using kind_t = std::size_t;
+
+private:
+    using Duration = std::chrono::steady_clock::duration;
+
+    struct Kind {
+        std::atomic<Duration::rep> budget {0};  // NB: 0 => not cheap
+        std::atomic<bool> demoted {false};
+    };
+
+    Executor* const _executor;
+    Kind _kinds[MaxKinds];
+    std::atomic<std::size_t> _inline_jobs;
+    std::atomic<std::size_t> _demotions;
+
+public:
+    /**
+     * create executor
+     * @param executor backing executor
+     */
+    explicit HybridExecutor(Executor* executor): _executor(executor), _inline_jobs(0), _demotions(0) {}
+
+    /**
+     * let jobs of the kind run inline as long as they fit the budget. clears a previous demotion
+     * @param kind job kind, less than \a MaxKinds
+     * @param budget max inline run time; zero sends all jobs of the kind to the backing executor
+     */
+    void set_budget(kind_t kind, const Duration& budget) {
+        if (kind >= MaxKinds) {
+            throw std::out_of_range(std::format("Job kind {} out of range", kind));
+        }
+        _kinds[kind].budget.store(budget.count(), std::memory_order_relaxed);
+        _kinds[kind].demoted.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return whether the kind has been demoted for overrunning its budget
+     */
+    bool demoted(kind_t kind) const {
+        return kind < MaxKinds && _kinds[kind].demoted.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return number of jobs run inline so far
+     */
+    std::size_t inline_jobs() const noexcept {
+        return _inline_jobs.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return number of demotions so far
+     */
+    std::size_t demotions() const noexcept {
+        return _demotions.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * execute job in the backing executor
+     * @param job job to execute
+     * @return future object. use it to obtain job result
+     */
+#ifndef YATQ_DISABLE_FUTURES
+    Future
+#else
+    void
+#endif
+    execute(Executable job) {
+        return _executor->execute(std::move(job));
+    }
+
+    /**
+     * execute job in the backing executor discarding its result
+     * @param job job to execute
+     */
+    void execute_detached(Executable job) {
+        _executor->execute_detached(std::move(job));
+    }
+
+#ifndef YATQ_DISABLE_FUTURES
+    /**
+     * execute job in the backing executor and store its result straight into the given slot
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     */
+    void execute(Executable job, Slot slot) {
+        _executor->execute(std::move(job), std::move(slot));
+    }
+
+    /**
+     * execute job in the backing executor unless it refuses the job. see \a ThreadPool::try_execute()
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     */
+    auto try_execute(Executable job, Slot slot) requires internal::TryExecutorGeneric<Executor> {
+        return _executor->try_execute(std::move(job), std::move(slot));
+    }
+#else
+    /**
+     * execute job in the backing executor unless it refuses the job. see \a ThreadPool::try_execute()
+     * @param job job to execute
+     */
+    auto try_execute(Executable job) requires internal::TryExecutorGeneric<Executor> {
+        return _executor->try_execute(std::move(job));
+    }
+#endif
+
+    /**
+     * resume suspended coroutine in the backing executor
+     * @param handle coroutine handle
+     */
+    void resume(std::coroutine_handle<> handle) requires internal::ResumingExecutorGeneric<Executor> {
+        _executor->resume(handle);
+    }
+
+    /**
+     * execute job in the calling thread if its kind is cheap and not demoted, in the backing executor otherwise
+     * @param kind job kind
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     */
+#ifndef YATQ_DISABLE_FUTURES
+    void execute_inline(kind_t kind, Executable job, Slot slot) {
+#else
+    void execute_inline(kind_t kind, Executable job) {
+#endif
+        if (kind >= MaxKinds || _kinds[kind].demoted.load(std::memory_order_relaxed)) {
+#ifndef YATQ_DISABLE_FUTURES
+            dispatch(std::move(job), std::move(slot));
+#else
+            dispatch(std::move(job));
+#endif
+            return;
+        }
+        auto budget = _kinds[kind].budget.load(std::memory_order_relaxed);
+        if (budget == 0) {
+#ifndef YATQ_DISABLE_FUTURES
+            dispatch(std::move(job), std::move(slot));
+#else
+            dispatch(std::move(job));
+#endif
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+#ifndef YATQ_DISABLE_FUTURES
+        if (slot) {
+            internal::run_and_complete<result_type>(job, slot);
+        }
+        else {
+            run_detached(job);
+        }
+#else
+        run_detached(job);
+#endif
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        _inline_jobs.fetch_add(1, std::memory_order_relaxed);
+        if (elapsed.count() > budget) {
+            demote(kind, elapsed, Duration(budget));
+        }
+    }
+
+private:
+#ifndef YATQ_DISABLE_FUTURES
+    void dispatch(Executable&& job, Slot&& slot) {
+        if constexpr (internal::TryExecutorGeneric<Executor>) {
+            _executor->try_execute(std::move(job), std::move(slot));  // NB: never block the calling thread
+        }
+        else {
+            _executor->execute(std::move(job), std::move(slot));
+        }
+    }
+#else
+    void dispatch(Executable&& job) {
+        if constexpr (internal::TryExecutorGeneric<Executor>) {
+            _executor->try_execute(std::move(job));  // NB: never block the calling thread
+        }
+        else {
+            _executor->execute(std::move(job));
+        }
+    }
+#endif
+
+    void demote(kind_t kind, const Duration& elapsed, const Duration& budget) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.hybrid_executor");
+#endif
+
+        if (!_kinds[kind].demoted.exchange(true, std::memory_order_relaxed)) {
+            _demotions.fetch_add(1, std::memory_order_relaxed);
+            LOG4CXX_WARN(
+                logger,
+                std::format(
+                    "Job kind {} demoted: ran inline for {} ns, budget {} ns",
+                    kind,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(budget).count()
+                )
+            );
+        }
+    }
+
+    static void run_detached(Executable& job) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.hybrid_executor");
+#endif
+
+        try {
+            job();
+        }
+        catch (const std::exception& exc) {
+            LOG4CXX_WARN(logger, std::format("Detached job failed: {}", exc.what()));
+        }
+        catch (...) {
+            LOG4CXX_WARN(logger, "Detached job failed");
+        }
+    }
+};
+
+}
+
+#endif
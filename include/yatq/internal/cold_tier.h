@@ -0,0 +1,204 @@
+#ifndef _YATQ_INTERNAL_COLD_TIER_H
+#define _YATQ_INTERNAL_COLD_TIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "yatq/job_registry.h"
+#include "yatq/utils/mmap_utils.h"
+
+namespace yatq::internal {
+
+constexpr std::uint32_t cold_staged = 1;
+constexpr std::uint32_t cold_canceled = 2;
+
+typedef struct {
+    std::uint64_t uid;
+    std::int64_t deadline;  // NB: clock ticks since epoch
+    std::int32_t priority;
+    std::uint32_t flags;
+    JobDescriptor descriptor;
+} ColdRecord;
+
+// far-future timers kept on disk rather than in memory: one append-only memory-mapped segment file per time bucket.
+// records are appended in uid order => a segment is searched by uid in O(log n), and a canceled record is only flagged.
+// not thread safe
+class ColdTier {
+private:
+    static constexpr std::size_t initial_records = 64;
+
+    struct Segment {
+        utils::MappedFile file;
+        std::size_t count;
+        std::uint64_t first_uid;
+        std::uint64_t last_uid;
+    };
+
+    std::string _directory;
+    std::int64_t _bucket_width;
+    std::map<std::int64_t, Segment> _segments;
+    std::size_t _size;
+
+public:
+    ColdTier(std::string directory, std::int64_t bucket_width):
+        _directory(std::move(directory)),
+        _bucket_width(bucket_width),
+        _size(0) {}
+
+    ColdTier(const ColdTier&) = delete;
+    ColdTier& operator=(const ColdTier&) = delete;
+
+    ~ColdTier() {
+        clear();
+    }
+
+    // NB: floor division => negative deadlines work too
+    std::int64_t bucket(std::int64_t deadline) const noexcept {
+        auto bucket = deadline / _bucket_width;
+        return (deadline % _bucket_width < 0) ? bucket - 1 : bucket;
+    }
+
+    std::int64_t bucket_start(std::int64_t bucket) const noexcept {
+        return bucket * _bucket_width;
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    // NB: the record uid must be greater than any appended before; returns whether a new segment has been created
+    bool append(const ColdRecord& record) {
+        auto bucket = this->bucket(record.deadline);
+        auto [i, is_new] = _segments.try_emplace(bucket);
+        auto& segment = i->second;
+        if (is_new) {
+            try {
+                segment.file = utils::MappedFile(path(bucket), initial_records * sizeof(ColdRecord));
+                segment.count = 0;
+                segment.first_uid = record.uid;
+            }
+            catch (...) {
+                _segments.erase(i);
+                throw;
+            }
+        }
+        else if ((segment.count + 1) * sizeof(ColdRecord) > segment.file.size()) {
+            segment.file.resize(2 * segment.file.size());
+        }
+        std::memcpy(segment.file.data() + segment.count * sizeof(ColdRecord), &record, sizeof(ColdRecord));
+        ++segment.count;
+        segment.last_uid = record.uid;
+        ++_size;
+        return is_new;
+    }
+
+    bool cancel(std::uint64_t uid) {
+        for (auto&& [bucket, segment]: _segments) {
+            if (uid < segment.first_uid || uid > segment.last_uid) {
+                continue;
+            }
+            auto offset = find(segment, uid);
+            if (offset == nullptr) {
+                continue;
+            }
+            std::uint32_t flags;
+            std::memcpy(&flags, offset + offsetof(ColdRecord, flags), sizeof(flags));
+            if (flags & cold_canceled) {
+                return false;
+            }
+            flags |= cold_canceled;
+            std::memcpy(offset + offsetof(ColdRecord, flags), &flags, sizeof(flags));
+            --_size;
+            return true;
+        }
+        return false;
+    }
+
+    std::optional<std::int64_t> first_bucket() const noexcept {
+        if (_segments.empty()) {
+            return std::nullopt;
+        }
+        return _segments.begin()->first;
+    }
+
+    // remove buckets up to the given one and return their pending records
+    std::vector<ColdRecord> take(std::int64_t last_bucket) {
+        std::vector<ColdRecord> records;
+        while (!_segments.empty() && _segments.begin()->first <= last_bucket) {
+            auto node = _segments.extract(_segments.begin());
+            auto& segment = node.mapped();
+            records.reserve(records.size() + segment.count);
+            for (std::size_t i = 0; i < segment.count; ++i) {
+                ColdRecord record;
+                std::memcpy(&record, segment.file.data() + i * sizeof(ColdRecord), sizeof(ColdRecord));
+                if (!(record.flags & cold_canceled)) {
+                    records.push_back(record);
+                }
+            }
+            segment.file.close();
+            std::remove(path(node.key()).c_str());
+        }
+        _size -= records.size();
+        return records;
+    }
+
+    // NB: pending records only
+    template<typename F>
+    void for_each(F&& f) const {
+        for (auto&& [bucket, segment]: _segments) {
+            for (std::size_t i = 0; i < segment.count; ++i) {
+                ColdRecord record;
+                std::memcpy(&record, segment.file.data() + i * sizeof(ColdRecord), sizeof(ColdRecord));
+                if (!(record.flags & cold_canceled)) {
+                    f(record);
+                }
+            }
+        }
+    }
+
+    void clear() {
+        for (auto&& [bucket, segment]: _segments) {
+            segment.file.close();
+            std::remove(path(bucket).c_str());
+        }
+        _segments.clear();
+        _size = 0;
+    }
+
+private:
+    std::string path(std::int64_t bucket) const {
+        return _directory + "/" + std::to_string(bucket) + ".seg";
+    }
+
+    static std::byte* find(Segment& segment, std::uint64_t uid) {
+        std::size_t low = 0;
+        std::size_t high = segment.count;
+        while (low < high) {
+            auto middle = low + (high - low) / 2;
+            auto offset = segment.file.data() + middle * sizeof(ColdRecord);
+            std::uint64_t middle_uid;
+            std::memcpy(&middle_uid, offset + offsetof(ColdRecord, uid), sizeof(middle_uid));
+            if (middle_uid == uid) {
+                return offset;
+            }
+            if (middle_uid < uid) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        return nullptr;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef _YATQ_MOVE_ONLY_FUNCTION_H
+#define _YATQ_MOVE_ONLY_FUNCTION_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace yatq {
+
+template<typename Signature, std::size_t InlineSize = 64>
+class MoveOnlyFunction;
+
+/**
+ * move-only callable wrapper. unlike \a std::function it accepts non-copyable callables and stores callables up to
+ * \a InlineSize bytes (and nothrow move constructible) within the object itself; larger callables are heap allocated
+ * @tparam R return type
+ * @tparam Args argument types
+ * @tparam InlineSize inline buffer size in bytes
+ */
+template<typename R, typename... Args, std::size_t InlineSize>
+class MoveOnlyFunction<R(Args...), InlineSize> {
+public:
+    using result_type = R;
+
+private:
+    typedef struct {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*move)(void* dst, void* src) noexcept;  // move-construct 'dst' from 'src' and destroy 'src'
+        void (*destroy)(void* storage) noexcept;
+    } VTable;
+
+    template<typename F>
+    static constexpr bool fits_inline =
+            sizeof(F) <= InlineSize &&
+            alignof(F) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible_v<F>;
+
+    template<typename F>
+    static constexpr VTable inline_vtable {
+        [] (void* storage, Args&&... args) -> R {
+            return std::invoke(*static_cast<F*>(storage), std::forward<Args>(args)...);
+        },
+        [] (void* dst, void* src) noexcept {
+            ::new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        },
+        [] (void* storage) noexcept {
+            static_cast<F*>(storage)->~F();
+        }
+    };
+
+    template<typename F>
+    static constexpr VTable heap_vtable {
+        [] (void* storage, Args&&... args) -> R {
+            return std::invoke(**static_cast<F**>(storage), std::forward<Args>(args)...);
+        },
+        [] (void* dst, void* src) noexcept {
+            *static_cast<F**>(dst) = *static_cast<F**>(src);
+        },
+        [] (void* storage) noexcept {
+            delete *static_cast<F**>(storage);
+        }
+    };
+
+    alignas(std::max_align_t) std::byte _storage[InlineSize < sizeof(void*) ? sizeof(void*) : InlineSize];
+    const VTable* _vtable;
+
+public:
+    /**
+     * create empty callable
+     */
+    MoveOnlyFunction() noexcept: _vtable(nullptr) {}
+
+    MoveOnlyFunction(std::nullptr_t) noexcept: _vtable(nullptr) {}
+
+    /**
+     * wrap callable
+     * @param f callable object; stored inline if fits into the buffer, heap allocated otherwise
+     */
+    template<typename F>
+    requires (
+        !std::is_same_v<std::remove_cvref_t<F>, MoveOnlyFunction> &&
+        std::is_invocable_r_v<R, std::decay_t<F>&, Args...>
+    )
+    MoveOnlyFunction(F&& f) {
+        using Callable = std::decay_t<F>;
+        if constexpr (fits_inline<Callable>) {
+            ::new (static_cast<void*>(_storage)) Callable(std::forward<F>(f));
+            _vtable = &inline_vtable<Callable>;
+        }
+        else {
+            *reinterpret_cast<Callable**>(_storage) = new Callable(std::forward<F>(f));
+            _vtable = &heap_vtable<Callable>;
+        }
+    }
+
+    MoveOnlyFunction(MoveOnlyFunction&& other) noexcept: _vtable(other._vtable) {
+        if (_vtable) {
+            _vtable->move(_storage, other._storage);
+            other._vtable = nullptr;
+        }
+    }
+
+    MoveOnlyFunction& operator=(MoveOnlyFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other._vtable) {
+                other._vtable->move(_storage, other._storage);
+                _vtable = other._vtable;
+                other._vtable = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    MoveOnlyFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    MoveOnlyFunction(const MoveOnlyFunction&) = delete;
+    MoveOnlyFunction& operator=(const MoveOnlyFunction&) = delete;
+
+    ~MoveOnlyFunction() {
+        reset();
+    }
+
+    /**
+     * invoke stored callable. the behavior is undefined if empty
+     */
+    R operator()(Args... args) {
+        return _vtable->invoke(_storage, std::forward<Args>(args)...);
+    }
+
+    /**
+     * check whether a callable is stored
+     */
+    explicit operator bool() const noexcept {
+        return _vtable != nullptr;
+    }
+
+private:
+    void reset() noexcept {
+        if (_vtable) {
+            _vtable->destroy(_storage);
+            _vtable = nullptr;
+        }
+    }
+};
+
+}
+
+#endif
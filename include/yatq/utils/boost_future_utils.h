@@ -0,0 +1,48 @@
+#ifndef _YATQ_UTILS_BOOST_FUTURE_UTILS_H
+#define _YATQ_UTILS_BOOST_FUTURE_UTILS_H
+
+#include <utility>
+
+#define BOOST_THREAD_PROVIDES_FUTURE
+#define BOOST_THREAD_PROVIDES_FUTURE_CONTINUATION
+#include <boost/thread/future.hpp>
+
+#include "yatq/completion.h"
+#include "yatq/internal/concepts.h"
+#include "yatq/internal/promise_utils.h"
+
+namespace yatq::internal {
+
+// NB: 'boost::future::then()' launches continuations 'async' by default, i.e. a thread per continuation
+template<typename T>
+struct FutureChain<boost::future<T>> {
+    template<typename F>
+    static void then(boost::future<T>& future, F&& func) {
+        future.then(boost::launch::sync, std::forward<F>(func));
+    }
+};
+
+}
+
+namespace yatq::utils {
+
+/**
+ * turn completion handle into \a boost::future (costs a \a boost::promise and its shared state)
+ * @param handle completion handle; becomes invalid
+ * @return future object chained with the completion
+ */
+template<typename T>
+boost::future<T> to_boost_future(CompletionHandle<T>&& handle) {
+    boost::promise<T> promise;
+    auto future = promise.get_future();
+    handle.then(
+        [promise = std::move(promise)]
+        (CompletionHandle<T> handle) mutable
+        { internal::get_and_set_value<T>(std::move(handle), std::move(promise)); }
+    );
+    return future;
+}
+
+}
+
+#endif
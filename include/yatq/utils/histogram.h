@@ -0,0 +1,173 @@
+#ifndef _YATQ_UTILS_HISTOGRAM_H
+#define _YATQ_UTILS_HISTOGRAM_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace yatq::utils {
+
+/**
+ * histogram summary; values in recorded units (e.g. nanoseconds)
+ */
+typedef struct {
+    std::uint64_t count;
+    std::uint64_t min;
+    std::uint64_t max;
+    double mean;
+    std::uint64_t p50;
+    std::uint64_t p90;
+    std::uint64_t p99;
+    std::uint64_t p999;
+} HistogramSummary;
+
+/**
+ * lock-free HDR-style histogram of non-negative values: buckets are exact below 16, then 16 linear sub-buckets per
+ * power of 2, i.e. a relative error of 1/16 at most over the whole 64-bit range in 8 KB. recording is a couple of
+ * relaxed atomic additions, so any thread may record; quantiles are approximate while values are being recorded
+ */
+class Histogram {
+private:
+    static constexpr unsigned sub_bits = 4;
+    static constexpr std::uint64_t sub_buckets = std::uint64_t(1) << sub_bits;
+    static constexpr std::size_t total_buckets = (64 - sub_bits + 1) * sub_buckets;
+
+    std::atomic<std::uint64_t> _buckets[total_buckets];
+    std::atomic<std::uint64_t> _count;
+    std::atomic<std::uint64_t> _sum;
+    std::atomic<std::uint64_t> _min;
+    std::atomic<std::uint64_t> _max;
+
+public:
+    Histogram() noexcept {
+        reset();
+    }
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    /**
+     * @param value value to record
+     */
+    void record(std::uint64_t value) noexcept {
+        _buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+        auto min = _min.load(std::memory_order_relaxed);
+        while (value < min && !_min.compare_exchange_weak(min, value, std::memory_order_relaxed)) {}
+        auto max = _max.load(std::memory_order_relaxed);
+        while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     * add the values recorded by another histogram, e.g. to sum up per-thread histograms
+     * @param other histogram to add
+     */
+    void merge(const Histogram& other) noexcept {
+        for (std::size_t i = 0; i < total_buckets; ++i) {
+            auto count = other._buckets[i].load(std::memory_order_relaxed);
+            if (count > 0) {
+                _buckets[i].fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+        _count.fetch_add(other._count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        _sum.fetch_add(other._sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        auto other_min = other._min.load(std::memory_order_relaxed);
+        auto min = _min.load(std::memory_order_relaxed);
+        while (other_min < min && !_min.compare_exchange_weak(min, other_min, std::memory_order_relaxed)) {}
+        auto other_max = other._max.load(std::memory_order_relaxed);
+        auto max = _max.load(std::memory_order_relaxed);
+        while (other_max > max && !_max.compare_exchange_weak(max, other_max, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     * @return number of values recorded
+     */
+    std::uint64_t count() const noexcept {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @param q quantile, 0..1
+     * @return highest value equivalent to the quantile (within the bucket precision); 0 if empty
+     */
+    std::uint64_t quantile(double q) const noexcept {
+        std::uint64_t total = 0;
+        for (auto&& bucket: _buckets) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        if (total == 0) {
+            return 0;
+        }
+        auto rank = static_cast<std::uint64_t>(std::clamp(q, 0.0, 1.0) * (total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < total_buckets; ++i) {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(upper_bound(i), _max.load(std::memory_order_relaxed));
+            }
+        }
+        return _max.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return count, min, max, mean and the usual percentiles
+     */
+    HistogramSummary summary() const noexcept {
+        auto count = this->count();
+        if (count == 0) {
+            return {};
+        }
+        return {
+            count,
+            _min.load(std::memory_order_relaxed),
+            _max.load(std::memory_order_relaxed),
+            static_cast<double>(_sum.load(std::memory_order_relaxed)) / count,
+            quantile(0.5),
+            quantile(0.9),
+            quantile(0.99),
+            quantile(0.999)
+        };
+    }
+
+    /**
+     * forget recorded values. values recorded meanwhile may be partly lost
+     */
+    void reset() noexcept {
+        for (auto&& bucket: _buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        _count.store(0, std::memory_order_relaxed);
+        _sum.store(0, std::memory_order_relaxed);
+        _min.store(UINT64_MAX, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static std::size_t index(std::uint64_t value) noexcept {
+        if (value < sub_buckets) {
+            return value;
+        }
+        unsigned msb = std::bit_width(value) - 1;
+        auto octave = msb - sub_bits + 1;
+        auto sub = (value >> (msb - sub_bits)) - sub_buckets;
+        return octave * sub_buckets + sub;
+    }
+
+    static std::uint64_t upper_bound(std::size_t index) noexcept {
+        if (index < sub_buckets) {
+            return index;
+        }
+        auto octave = index / sub_buckets;
+        auto sub = index % sub_buckets;
+        auto msb = octave + sub_bits - 1;
+        auto width = std::uint64_t(1) << (msb - sub_bits);
+        return (std::uint64_t(1) << msb) + sub * width + (width - 1);
+    }
+};
+
+}
+
+#endif
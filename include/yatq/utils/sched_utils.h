@@ -2,10 +2,19 @@
 #define _YATQ_UTILS_SCHED_UTILS_H
 
 #include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstring>
 #include <format>
 #include <string>
+#include <vector>
 
 #include <pthread.h>
+#include <sched.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "yatq/internal/log4cxx_proxy.h"
 #include "yatq/utils/logging_utils.h"
@@ -14,6 +23,40 @@ namespace yatq::utils {
 
 typedef enum {min_priority = 0, max_priority = -1} priority_t;
 
+/**
+ * placement of a group of worker threads
+ */
+typedef struct {
+    /**
+     * number of threads in the group
+     */
+    std::size_t num_threads;
+    /**
+     * CPUs the threads may run on; empty means no affinity. use a single CPU per group to pin each thread
+     */
+    std::vector<int> cpus;
+    /**
+     * NUMA node to allocate thread memory from; -1 means no binding
+     */
+    int numa_node = -1;
+} ThreadGroup;
+
+/**
+ * resolve priority tag into explicit priority
+ * @param sched_policy \a SCHED_OTHER | \a SCHED_RR | \a SCHED_FIFO
+ * @param priority_tag \a yatq::utils::max_priority | \a yatq::utils::min_priority
+ * @return explicit priority
+ */
+inline int get_priority(int sched_policy, priority_t priority_tag) {
+    switch (priority_tag) {
+        case min_priority:
+            return sched_get_priority_min(sched_policy);
+        case max_priority:
+        default:
+            return sched_get_priority_max(sched_policy);
+    }
+}
+
 /**
  * set scheduling parameters for a thread
  * @param handle thread handle
@@ -56,16 +99,66 @@ inline bool set_sched_params(pthread_t handle, int sched_policy, int priority, c
  * @return \a true if scheduling parameters have been set and \a false otherwise
  */
 inline bool set_sched_params(pthread_t handle, int sched_policy, priority_t priority_tag, const std::string& thread_tag = "unspecified") {
-    int priority;
-    switch (priority_tag) {
-        case min_priority:
-            priority = sched_get_priority_min(sched_policy);
-            break;
-        case max_priority:
-            priority = sched_get_priority_max(sched_policy);
-            break;
+    return set_sched_params(handle, sched_policy, get_priority(sched_policy, priority_tag), thread_tag);
+}
+
+/**
+ * restrict a thread to a set of CPUs
+ * @param handle thread handle
+ * @param cpus CPU numbers
+ * @param thread_tag thread tag (used for logging purposes only)
+ * @return \a true if CPU affinity has been set and \a false otherwise
+ */
+inline bool set_cpu_affinity(pthread_t handle, const std::vector<int>& cpus, const std::string& thread_tag = "unspecified") {
+#ifndef YATQ_DISABLE_LOGGING
+    static auto logger = log4cxx::Logger::getLogger("yatq.utils.sched");
+#endif
+
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (auto cpu: cpus) {
+        CPU_SET(cpu, &cpu_set);
     }
-    return set_sched_params(handle, sched_policy, priority, thread_tag);
+    auto error = pthread_setaffinity_np(handle, sizeof(cpu_set), &cpu_set);  // NB: returns error code, 'errno' intact
+    if (error == 0) {
+        LOG4CXX_INFO(logger, std::format("Set CPU affinity thread='{}' cpus={}", thread_tag, cpus.size()));
+        return true;
+    }
+    LOG4CXX_WARN(logger, std::format("Failed to set CPU affinity thread='{}': {}", thread_tag, std::strerror(error)));
+#else
+    LOG4CXX_WARN(logger, std::format("Failed to set CPU affinity thread='{}': not supported", thread_tag));
+#endif
+    return false;
+}
+
+/**
+ * bind memory allocations of the calling thread to a NUMA node (\a set_mempolicy(MPOL_BIND)). Linux only; no
+ * \a libnuma required
+ * @param numa_node NUMA node number
+ * @param thread_tag thread tag (used for logging purposes only)
+ * @return \a true if memory policy has been set and \a false otherwise
+ */
+inline bool set_numa_node(int numa_node, const std::string& thread_tag = "unspecified") {
+#ifndef YATQ_DISABLE_LOGGING
+    static auto logger = log4cxx::Logger::getLogger("yatq.utils.sched");
+#endif
+
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    constexpr int mpol_bind = 2;  // NB: 'MPOL_BIND' from <linux/mempolicy.h>
+    constexpr std::size_t bits = sizeof(unsigned long) * CHAR_BIT;
+    std::vector<unsigned long> node_mask(numa_node / bits + 1, 0);
+    node_mask[numa_node / bits] |= 1ul << (numa_node % bits);
+    // NB: the kernel ignores the last bit of 'maxnode'
+    if (::syscall(SYS_set_mempolicy, mpol_bind, node_mask.data(), node_mask.size() * bits + 1) == 0) {
+        LOG4CXX_INFO(logger, std::format("Set NUMA node thread='{}' node={}", thread_tag, numa_node));
+        return true;
+    }
+    LOG4CXX_WARN(logger, std::format("Failed to set NUMA node thread='{}': {}", thread_tag, std::strerror(errno)));
+#else
+    LOG4CXX_WARN(logger, std::format("Failed to set NUMA node thread='{}': not supported", thread_tag));
+#endif
+    return false;
 }
 
 }
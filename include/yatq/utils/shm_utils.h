@@ -0,0 +1,150 @@
+#ifndef _YATQ_UTILS_SHM_UTILS_H
+#define _YATQ_UTILS_SHM_UTILS_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace yatq::utils {
+
+/**
+ * POSIX shared memory object mapped read-write, unmapped on destruction. the creator also removes the name on
+ * destruction. Linux only
+ */
+class SharedMemory {
+private:
+    std::string _name;
+    std::byte* _data;
+    std::size_t _size;
+    bool _owner;
+
+public:
+    /**
+     * create shared memory object, replacing a stale one of the same name
+     * @param name object name, e.g. "/app_timers"
+     * @param size object size
+     */
+    SharedMemory(const std::string& name, std::size_t size): _name(name), _data(nullptr), _size(size), _owner(true) {
+        ::shm_unlink(name.c_str());
+        auto fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            auto error = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::system_error(error, std::generic_category(), "ftruncate " + name);
+        }
+        map(fd);
+    }
+
+    /**
+     * open existing shared memory object
+     * @param name object name
+     */
+    explicit SharedMemory(const std::string& name): _name(name), _data(nullptr), _size(0), _owner(false) {
+        auto fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            auto error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "fstat " + name);
+        }
+        _size = static_cast<std::size_t>(st.st_size);
+        map(fd);
+    }
+
+    SharedMemory(SharedMemory&& other) noexcept:
+        _name(std::move(other._name)),
+        _data(std::exchange(other._data, nullptr)),
+        _size(std::exchange(other._size, 0)),
+        _owner(std::exchange(other._owner, false)) {}
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+    SharedMemory& operator=(SharedMemory&&) = delete;
+
+    ~SharedMemory() {
+        if (_data) {
+            ::munmap(_data, _size);
+        }
+        if (_owner) {
+            ::shm_unlink(_name.c_str());
+        }
+    }
+
+    std::byte* data() const noexcept {
+        return _data;
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+private:
+    void map(int fd) {
+        auto data = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        auto error = errno;
+        ::close(fd);  // NB: the mapping stays
+        if (data == MAP_FAILED) {
+            if (_owner) {
+                ::shm_unlink(_name.c_str());
+            }
+            throw std::system_error(error, std::generic_category(), "mmap " + _name);
+        }
+        _data = static_cast<std::byte*>(data);
+    }
+};
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "Futex word must be a plain 32-bit integer");
+
+/**
+ * block while the word shared between processes holds the expected value
+ * @param word futex word
+ * @param expected value to block on
+ * @param timeout optional relative timeout; negative => no timeout
+ * @return \a false on timeout; \a true otherwise (woken, value changed or interrupted)
+ */
+inline bool futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1)) {
+    struct timespec ts;
+    struct timespec* pts = nullptr;
+    if (timeout >= std::chrono::nanoseconds::zero()) {
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1'000'000'000);
+        ts.tv_nsec = static_cast<long>(timeout.count() % 1'000'000'000);
+        pts = &ts;
+    }
+    // NB: no FUTEX_PRIVATE_FLAG => works across processes
+    auto result = ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, pts, nullptr, 0);
+    return !(result == -1 && errno == ETIMEDOUT);
+}
+
+/**
+ * wake processes blocked on the word
+ * @param word futex word
+ * @param count max number of waiters to wake
+ */
+inline void futex_wake(std::atomic<std::uint32_t>& word, int count = INT_MAX) {
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+}
+
+#endif
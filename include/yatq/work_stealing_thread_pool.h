@@ -0,0 +1,377 @@
+#ifndef _YATQ_WORK_STEALING_THREAD_POOL_H
+#define _YATQ_WORK_STEALING_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "yatq/internal/concepts.h"
+#include "yatq/internal/log4cxx_proxy.h"
+#include "yatq/utils/sync_utils.h"
+#ifndef YATQ_DISABLE_FUTURES
+#include "yatq/completion.h"
+#endif
+#include "yatq/move_only_function.h"
+
+namespace yatq {
+
+using internal::ExecutableGeneric;
+using internal::SyncGeneric;
+
+/**
+ * thread pool with a job queue per thread. jobs submitted from outside are distributed round-robin, jobs submitted
+ * from a pool thread go to its own queue. a thread runs its own jobs in order and steals the newest jobs of other
+ * threads when out of work. drop-in replacement for \a ThreadPool, except that jobs cannot be submitted before the
+ * first \a start()
+ */
+template<ExecutableGeneric _Executable = MoveOnlyFunction<void(void)>, SyncGeneric _Sync = utils::StdSync>
+class WorkStealingThreadPool {
+public:
+    using Executable = _Executable;
+    using Sync = _Sync;
+    using result_type = internal::executable_result_t<Executable>;
+#ifndef YATQ_DISABLE_FUTURES
+    using Future = CompletionHandle<result_type>;
+    using Slot = CompletionSlot<result_type>;
+#endif
+
+private:
+    using Mutex = Sync::mutex;
+    using ConditionVariable = Sync::condition_variable;
+
+    typedef struct {
+        Executable job;
+#ifndef YATQ_DISABLE_FUTURES
+        Slot slot;
+#endif
+        std::coroutine_handle<> coroutine;  // NB: set for coroutines to resume only
+    } QueueEntry;
+
+    // NB: the owner pops at the front (timer jobs keep their order), thieves take from the back
+    typedef struct {
+        Mutex lock;
+        std::deque<QueueEntry> queue;
+    } Worker;
+
+    typedef struct {
+        WorkStealingThreadPool* pool;
+        std::size_t index;
+    } CurrentWorker;
+
+    static constexpr std::size_t max_steal = 32;
+
+    inline static thread_local CurrentWorker _current_worker {nullptr, 0};
+
+    std::atomic<bool> _running;
+    const std::size_t _max_threads;
+    std::unique_ptr<std::unique_ptr<Worker>[]> _workers;  // NB: allocated once => never moves under a submitter
+    std::atomic<std::size_t> _num_workers;  // NB: published after the workers are made
+    std::vector<std::thread> _pool;
+    std::atomic<std::size_t> _next_worker;
+    std::atomic<std::size_t> _pending;  // queued entries over all the workers
+    std::atomic<std::size_t> _idle;  // parked threads
+    std::atomic<std::size_t> _searching;  // threads awake and looking for work
+    Mutex _park_lock;
+    ConditionVariable _park_cond;
+#ifndef YATQ_DISABLE_FUTURES
+    CompletionPool<result_type, Sync> _completions;
+#endif
+
+public:
+    /**
+     * create thread pool
+     * @param max_threads max number of threads any \a start() may ask for; worker storage is allocated once for that
+     * many, so a restart adding threads does not race with submissions
+     */
+    explicit WorkStealingThreadPool(std::size_t max_threads = 256):
+        _running(false),
+        _max_threads(max_threads),
+        _workers(new std::unique_ptr<Worker>[max_threads]),
+        _num_workers(0),
+        _next_worker(0),
+        _pending(0),
+        _idle(0),
+        _searching(0) {}
+
+    /**
+     * start thread pool. queues and the jobs left in them survive \a stop() => a restart starts as many threads as the
+     * largest previous start at least, so that every queue has an owner. throws \a std::invalid_argument beyond the max
+     * number of threads (see the constructor)
+     * @param num_threads number of threads
+     */
+    void start(std::size_t num_threads) {
+        if (num_threads > _max_threads) {
+            throw std::invalid_argument(std::format("Work stealing thread pool is limited to {} threads", _max_threads));
+        }
+        if (!_running) {
+            _running = true;
+            auto prev_num_workers = _num_workers.load(std::memory_order_relaxed);
+            auto num_workers = std::max(prev_num_workers, num_threads);  // NB: queues survive restart
+            for (auto i = prev_num_workers; i < num_workers; ++i) {
+                _workers[i] = std::make_unique<Worker>();
+            }
+            _num_workers.store(num_workers, std::memory_order_release);
+            for (std::size_t i = 0; i < num_workers; ++i) {
+                std::string thread_tag = std::format("pool thread #{}", i);
+                auto thread = std::thread(&WorkStealingThreadPool::thread_routine, this, i, std::move(thread_tag));
+                _pool.push_back(std::move(thread));
+            }
+        }
+    }
+
+    /**
+     * stop thread pool and join all the threads
+     */
+    void stop() {
+        if (_running) {
+            {
+                std::lock_guard<Mutex> guard(_park_lock);
+                _running = false;
+            }
+            _park_cond.notify_all();
+            for (auto&& thread: _pool) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+            _pool.clear();
+        }
+    }
+
+    /**
+     * execute job in a thread
+     * @param job job to execute
+     * @return future object. use it to obtain job result
+     */
+#ifndef YATQ_DISABLE_FUTURES
+    Future
+#else
+    void
+#endif
+    execute(Executable job) {
+#ifndef YATQ_DISABLE_FUTURES
+        auto [slot, future] = _completions.make();
+        push({std::move(job), std::move(slot)});
+        return std::move(future);
+#else
+        push({std::move(job)});
+#endif
+    }
+
+    /**
+     * execute job in a thread discarding its result. no promise is allocated
+     * @param job job to execute
+     */
+    void execute_detached(Executable job) {
+        push({std::move(job)});
+    }
+
+#ifndef YATQ_DISABLE_FUTURES
+    /**
+     * execute job in a thread and store its result straight into the given slot
+     * @param job job to execute
+     * @param slot completion slot to store job result
+     */
+    void execute(Executable job, Slot slot) {
+        push({std::move(job), std::move(slot)});
+    }
+#endif
+
+    /**
+     * resume suspended coroutine in a thread
+     * @param handle coroutine handle
+     */
+    void resume(std::coroutine_handle<> handle) {
+#ifndef YATQ_DISABLE_FUTURES
+        push({Executable(), Slot(), handle});
+#else
+        push({Executable(), handle});
+#endif
+    }
+
+private:
+    void push(QueueEntry&& queue_entry) {
+        std::size_t index;
+        if (_current_worker.pool == this) {
+            index = _current_worker.index;
+        }
+        else if (auto num_workers = _num_workers.load(std::memory_order_acquire); num_workers > 0) {
+            index = _next_worker.fetch_add(1, std::memory_order_relaxed) % num_workers;
+        }
+        else {
+            throw std::logic_error("Work stealing thread pool has never been started");
+        }
+        auto& worker = *_workers[index];
+        {
+            std::lock_guard<Mutex> guard(worker.lock);
+            worker.queue.push_back(std::move(queue_entry));
+        }
+        _pending.fetch_add(1, std::memory_order_seq_cst);
+        // NB: a searching thread will find the entry => no wakeup syscall
+        if (_searching.load(std::memory_order_seq_cst) == 0 && _idle.load(std::memory_order_seq_cst) > 0) {
+            wake_one();
+        }
+    }
+
+    void wake_one() {
+        // NB: lock => parking thread is either before its predicate check or waiting
+        { std::lock_guard<Mutex> guard(_park_lock); }
+        _park_cond.notify_one();
+    }
+
+    bool pop(std::size_t index, QueueEntry& queue_entry) {
+        auto& worker = *_workers[index];
+        std::lock_guard<Mutex> guard(worker.lock);
+        if (worker.queue.empty()) {
+            return false;
+        }
+        queue_entry = std::move(worker.queue.front());
+        worker.queue.pop_front();
+        return true;
+    }
+
+    // NB: takes up to half of the victim's entries so that the next few pickups need no scan
+    bool steal(std::size_t victim, std::size_t index, QueueEntry& queue_entry) {
+        std::deque<QueueEntry> stolen;
+        {
+            auto& worker = *_workers[victim];
+            std::unique_lock<Mutex> guard(worker.lock, std::try_to_lock);
+            if (!guard.owns_lock() || worker.queue.empty()) {
+                return false;
+            }
+            auto count = std::min((worker.queue.size() + 1) / 2, max_steal);
+            auto first = worker.queue.end() - count;
+            std::move(first, worker.queue.end(), std::back_inserter(stolen));
+            worker.queue.erase(first, worker.queue.end());
+        }
+        queue_entry = std::move(stolen.front());
+        stolen.pop_front();
+        if (!stolen.empty()) {
+            auto& worker = *_workers[index];
+            std::lock_guard<Mutex> guard(worker.lock);
+            std::move(stolen.begin(), stolen.end(), std::back_inserter(worker.queue));
+        }
+        return true;
+    }
+
+    bool take(std::size_t index, QueueEntry& queue_entry) {
+        if (pop(index, queue_entry)) {
+            return true;
+        }
+        auto num_workers = _num_workers.load(std::memory_order_acquire);
+        for (std::size_t i = 1; i < num_workers; ++i) {
+            if (steal((index + i) % num_workers, index, queue_entry)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void thread_routine(std::size_t index, std::string&& thread_tag) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.work_stealing_thread_pool");
+#endif
+
+        SET_THREAD_TAG(thread_tag);
+        LOG4CXX_INFO(logger, "Start");
+
+        _current_worker = {this, index};
+        _searching.fetch_add(1, std::memory_order_seq_cst);
+        bool searching = true;
+
+        while (_running) {
+            QueueEntry queue_entry;
+            if (!take(index, queue_entry)) {
+                if (searching) {
+                    searching = false;
+                    _searching.fetch_sub(1, std::memory_order_seq_cst);
+                }
+                {
+                    std::unique_lock<Mutex> guard(_park_lock);
+                    _idle.fetch_add(1, std::memory_order_seq_cst);
+                    _park_cond.wait(guard, [this] () {
+                        return _pending.load(std::memory_order_seq_cst) > 0 || !_running;
+                    });
+                    _idle.fetch_sub(1, std::memory_order_relaxed);
+                }
+                _searching.fetch_add(1, std::memory_order_seq_cst);
+                searching = true;
+                continue;  // NB: pending entry may be taken by another thread
+            }
+            _pending.fetch_sub(1, std::memory_order_seq_cst);
+            if (searching) {
+                searching = false;
+                // NB: the last searching thread hands searching over if there is more work
+                if (_searching.fetch_sub(1, std::memory_order_seq_cst) == 1 && _pending.load(std::memory_order_seq_cst) > 0) {
+                    wake_one();
+                }
+            }
+
+            if (queue_entry.coroutine) {
+                queue_entry.coroutine.resume();
+            }
+            else {
+                run(queue_entry);
+            }
+
+            _searching.fetch_add(1, std::memory_order_seq_cst);
+            searching = true;
+        }
+
+        if (searching) {
+            _searching.fetch_sub(1, std::memory_order_relaxed);
+        }
+        _current_worker = {nullptr, 0};
+        LOG4CXX_INFO(logger, "Stop");
+    }
+
+    static void run(QueueEntry& queue_entry) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.work_stealing_thread_pool");
+#endif
+
+        LOG4CXX_TRACE(logger, "Start job");
+#ifndef YATQ_DISABLE_FUTURES
+        if (queue_entry.slot) {
+            internal::run_and_complete<result_type>(queue_entry.job, queue_entry.slot);
+        }
+        else {
+            run_detached(queue_entry.job);
+        }
+#else
+        run_detached(queue_entry.job);
+#endif
+        LOG4CXX_TRACE(logger, "Job complete");
+    }
+
+    static void run_detached(Executable& job) {
+#ifndef YATQ_DISABLE_LOGGING
+        static auto logger = log4cxx::Logger::getLogger("yatq.work_stealing_thread_pool");
+#endif
+
+        try {
+            job();
+        }
+        catch (const std::exception& exc) {
+            LOG4CXX_WARN(logger, std::format("Detached job failed: {}", exc.what()));
+        }
+        catch (...) {
+            LOG4CXX_WARN(logger, "Detached job failed");
+        }
+    }
+};
+
+}
+
+#endif
@@ -1,14 +1,23 @@
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <fstream>
 #include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <unistd.h>
 
 #define YATQ_DISABLE_FUTURES
 #define YATQ_DISABLE_LOGGING
+#include "yatq/handoff_executor.h"
+#include "yatq/hybrid_executor.h"
+#include "yatq/scheduled_thread_pool.h"
+#include "yatq/thread_pool.h"
 #include "yatq/timer_queue.h"
 
 class InstantExecutor {
@@ -20,37 +29,159 @@ public:
     }
 };
 
-typedef yatq::TimerQueue<InstantExecutor, std::chrono::high_resolution_clock> HighResolutionTimerQueue;
+typedef std::chrono::high_resolution_clock Clock;
+typedef std::vector<Clock::duration::rep> Delays;
 
-void store_delay(
-        const HighResolutionTimerQueue::Clock::time_point& scheduled,
-        std::vector<HighResolutionTimerQueue::Clock::duration::rep>& delays
-) {
-    auto now = HighResolutionTimerQueue::Clock::now();
-    auto delay = now.time_since_epoch().count() - scheduled.time_since_epoch().count();
-    delays.push_back(delay);
+const auto N = 1'000;
+
+void store_delay(const Clock::time_point& scheduled, Clock::duration::rep& delay) {
+    auto now = Clock::now();
+    delay = now.time_since_epoch().count() - scheduled.time_since_epoch().count();
 }
 
-int main() {
-    InstantExecutor instant_executor;
-    HighResolutionTimerQueue timer_queue(&instant_executor);
-    timer_queue.start(SCHED_FIFO);
+void report(Delays& delays, const std::string& title, const std::string& filename) {
+    std::ofstream output(filename);
+    std::ostream_iterator<Clock::duration::rep> output_iterator(output, ",");
+    std::ranges::copy(delays, output_iterator);
 
-    std::vector<HighResolutionTimerQueue::Clock::duration::rep> delays;
+    std::ranges::sort(delays);
+    long double sum = 0;
+    for (auto delay: delays) {
+        sum += delay;
+    }
+    auto mean = sum / delays.size();
+    auto p50 = delays[delays.size() / 2];
+    auto p99 = delays[delays.size() * 99 / 100];
+    std::clog << title << ": " << delays.size() << " samples, mean=" << mean << " p50=" << p50 << " p99=" << p99 << " max=" << delays.back() << std::endl;
+}
+
+// NB: lateness is measured at job start, i.e. including the executor handoff
+template<typename TimerQueue, typename... Options>
+void measure(TimerQueue& timer_queue, const std::string& title, const std::string& filename, const Options&... options) {
+    Delays delays(N);
 
-    auto deadline = HighResolutionTimerQueue::Clock::now();
-    for (int i = 0; i < 1'000; ++i) {
+    auto deadline = Clock::now();
+    for (int i = 0; i < N; ++i) {
         deadline += std::chrono::milliseconds(10);
-        timer_queue.enqueue(deadline, [deadline, &delays] () { store_delay(deadline, delays); });
+        auto& delay = delays[i];
+        timer_queue.enqueue(deadline, [deadline, &delay] () { store_delay(deadline, delay); }, options...);
     }
 
-    ::sleep(10);
+    ::sleep(N / 100);
+
+    report(delays, title, filename);
+}
+
+// timers arriving behind a burst of non-urgent jobs (due in 5ms) submitted to a single pool thread right before them
+template<typename ThreadPool>
+void measure_backlog(const std::string& title, const std::string& filename) {
+    const auto burst = 50;
+
+    ThreadPool thread_pool;
+    thread_pool.start(1);
+    yatq::TimerQueue<ThreadPool, Clock> timer_queue(&thread_pool);
+    timer_queue.start(SCHED_FIFO);
+
+    auto submit_burst = [&thread_pool] () {
+        for (int i = 0; i < burst; ++i) {
+            auto job = [] () {
+                auto until = Clock::now() + std::chrono::microseconds(20);
+                while (Clock::now() < until) {}
+            };
+            if constexpr (requires { thread_pool.execute(job, std::chrono::steady_clock::time_point()); }) {
+                thread_pool.execute(job, std::chrono::steady_clock::now() + std::chrono::milliseconds(5));
+            }
+            else {
+                thread_pool.execute(job);
+            }
+        }
+    };
+
+    Delays delays(N);
+    auto deadline = Clock::now();
+    for (int i = 0; i < N; ++i) {
+        deadline += std::chrono::milliseconds(2);
+        auto& delay = delays[i];
+        timer_queue.enqueue(deadline - std::chrono::microseconds(200), submit_burst);
+        timer_queue.enqueue(deadline, [deadline, &delay] () { store_delay(deadline, delay); });
+    }
+    ::sleep(N / 500 + 1);
 
     timer_queue.stop();
+    thread_pool.stop();
 
-    std::ofstream output("tq_delays.dat");
-    std::ostream_iterator<HighResolutionTimerQueue::Clock::duration::rep> output_iterator(output, ",");
-    std::ranges::copy(delays, output_iterator);
+    report(delays, title, filename);
+}
+
+// sporadic timers 50-500us apart: the pool thread is idle most of the time
+void measure_sporadic(const yatq::utils::IdleStrategy& idle_strategy, const std::string& title, const std::string& filename) {
+    yatq::ThreadPool<> thread_pool;
+    thread_pool.set_idle_strategy(idle_strategy);
+    thread_pool.start(1);
+    yatq::TimerQueue<yatq::ThreadPool<>, Clock> timer_queue(&thread_pool);
+    timer_queue.start(SCHED_FIFO);
+
+    std::mt19937 random;
+    std::uniform_int_distribution<int> gap(50, 500);
+    Delays delays(N);
+    auto deadline = Clock::now() + std::chrono::milliseconds(10);
+    for (int i = 0; i < N; ++i) {
+        deadline += std::chrono::microseconds(gap(random));
+        auto& delay = delays[i];
+        timer_queue.enqueue(deadline, [deadline, &delay] () { store_delay(deadline, delay); });
+    }
+    std::this_thread::sleep_until(deadline + std::chrono::milliseconds(100));
+
+    timer_queue.stop();
+    thread_pool.stop();
+
+    report(delays, title, filename);
+}
+
+int main() {
+    std::clog.imbue(std::locale(""));
+
+    InstantExecutor instant_executor;
+    yatq::TimerQueue<InstantExecutor, Clock> timer_queue(&instant_executor);
+    timer_queue.start(SCHED_FIFO);
+    measure(timer_queue, "InstantExecutor", "tq_delays.dat");
+    timer_queue.stop();
+
+    yatq::ThreadPool<> thread_pool;
+    thread_pool.start(4);
+    yatq::TimerQueue<yatq::ThreadPool<>, Clock> tp_timer_queue(&thread_pool);
+    tp_timer_queue.start(SCHED_FIFO);
+    measure(tp_timer_queue, "ThreadPool", "tp_delays.dat");
+    measure(tp_timer_queue, "ThreadPool (staged)", "staged_delays.dat", yatq::TimerOptions {.stage = true});
+    tp_timer_queue.stop();
+
+    yatq::HybridExecutor<yatq::ThreadPool<>> hybrid_executor(&thread_pool);
+    hybrid_executor.set_budget(0, std::chrono::microseconds(50));
+    yatq::TimerQueue<yatq::HybridExecutor<yatq::ThreadPool<>>, Clock> hybrid_timer_queue(&hybrid_executor);
+    hybrid_timer_queue.start(SCHED_FIFO);
+    measure(hybrid_timer_queue, "HybridExecutor (inline)", "hybrid_delays.dat", yatq::TimerOptions {.inline_kind = 0});
+    hybrid_timer_queue.stop();
+    thread_pool.stop();
+
+    yatq::HandoffExecutor<> handoff_executor;
+    handoff_executor.start(4);
+    yatq::TimerQueue<yatq::HandoffExecutor<>, Clock> handoff_timer_queue(&handoff_executor);
+    handoff_timer_queue.start(SCHED_FIFO);
+    measure(handoff_timer_queue, "HandoffExecutor", "handoff_delays.dat");
+    handoff_timer_queue.stop();
+    handoff_executor.stop();
+
+    yatq::ScheduledThreadPool<yatq::MoveOnlyFunction<void(void)>, Clock> scheduled_thread_pool;
+    scheduled_thread_pool.start(4, SCHED_FIFO);
+    measure(scheduled_thread_pool, "ScheduledThreadPool", "stp_delays.dat");
+    scheduled_thread_pool.stop();
+
+    using DeadlineThreadPool = yatq::ThreadPool<yatq::MoveOnlyFunction<void(void)>, yatq::utils::StdSync, yatq::utils::DeadlineQueue>;
+    measure_backlog<yatq::ThreadPool<>>("ThreadPool (FIFO, backlog)", "fifo_backlog_delays.dat");
+    measure_backlog<DeadlineThreadPool>("ThreadPool (EDF, backlog)", "edf_backlog_delays.dat");
+
+    measure_sporadic({}, "ThreadPool (park, sporadic)", "park_sporadic_delays.dat");
+    measure_sporadic({.spin = 2'000, .yield = 2'000}, "ThreadPool (spin-then-park, sporadic)", "spin_sporadic_delays.dat");
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#define YATQ_DISABLE_FUTURES
+#define YATQ_DISABLE_LOGGING
+#include "yatq/timer_queue.h"
+#include "yatq/utils/sched_utils.h"
+#include "yatq/utils/sync_utils.h"
+
+class InstantExecutor {
+public:
+    using Executable = std::function<void(void)>;
+
+    static void execute(const Executable& job) {
+        job();
+    }
+};
+
+typedef std::chrono::high_resolution_clock Clock;
+typedef std::vector<Clock::duration::rep> Delays;
+
+const auto num_timers = 300;
+const auto timer_period = std::chrono::milliseconds(10);
+const auto spin_period = std::chrono::milliseconds(2);  // NB: the timer queue thread stalls for that long on inversion
+const auto sleep_period = std::chrono::milliseconds(1);
+
+// NB: all the threads share a single CPU => a preempted producer holding the lock stalls the timer queue thread
+bool pin_to_cpu(pthread_t handle, int cpu) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    auto error = pthread_setaffinity_np(handle, sizeof(cpu_set), &cpu_set);
+    if (error != 0) {
+        std::clog << "pthread_setaffinity_np failed: " << std::strerror(error) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// classic inversion: the SCHED_OTHER producer holds the lock, the medium priority SCHED_FIFO spinner preempts it and
+// the highest priority SCHED_FIFO timer queue thread waits for the lock until the spinner sleeps, unless the producer
+// inherits its priority
+template<typename Sync>
+std::optional<Delays> measure(const std::string& filename) {
+    using TimerQueue = yatq::TimerQueue<InstantExecutor, Clock, Sync>;
+
+    InstantExecutor instant_executor;
+    TimerQueue timer_queue(&instant_executor);
+    timer_queue.start(SCHED_FIFO, yatq::utils::max_priority);
+
+    // NB: the timer queue thread runs jobs itself => check its scheduling from a job
+    std::atomic<int> sched_policy = -1;
+    std::atomic<int> cpu = -1;
+    timer_queue.enqueue(Clock::now(), [&sched_policy, &cpu] () {
+        sched_param sched;
+        int policy;
+        pthread_getschedparam(pthread_self(), &policy, &sched);
+        cpu = sched_getcpu();
+        sched_policy = policy;
+    });
+    while (sched_policy == -1) {
+        std::this_thread::yield();
+    }
+    if (sched_policy != SCHED_FIFO || cpu != 0) {
+        std::clog << "timer queue thread is not SCHED_FIFO on CPU 0 (policy=" << sched_policy << " cpu=" << cpu << ")" << std::endl;
+        timer_queue.stop();
+        return std::nullopt;
+    }
+
+    std::atomic<bool> running = true;
+    std::thread producer([&timer_queue, &running] () {
+        auto far_future = Clock::now() + std::chrono::hours(1);
+        while (running) {  // NB: holds the lock most of the time
+            auto handle = timer_queue.enqueue(far_future, [] () {});
+            timer_queue.cancel(handle.uid);
+        }
+    });
+
+    std::atomic<bool> spinner_ready = false;
+    std::atomic<bool> spinner_ok = false;
+    std::thread spinner([&running, &spinner_ready, &spinner_ok] () {
+        auto priority = (sched_get_priority_min(SCHED_FIFO) + sched_get_priority_max(SCHED_FIFO)) / 2;
+        spinner_ok = yatq::utils::set_sched_params(pthread_self(), SCHED_FIFO, priority, "spinner");
+        spinner_ready = true;
+        while (running && spinner_ok) {
+            auto until = Clock::now() + spin_period;
+            while (Clock::now() < until) {}
+            std::this_thread::sleep_for(sleep_period);
+        }
+    });
+    while (!spinner_ready) {
+        std::this_thread::yield();
+    }
+
+    Delays delays;
+    delays.reserve(num_timers);
+    if (spinner_ok) {
+        auto deadline = Clock::now() + std::chrono::milliseconds(100);
+        for (int i = 0; i < num_timers; ++i) {
+            deadline += timer_period;
+            timer_queue.enqueue(deadline, [deadline, &delays] () {
+                auto now = Clock::now();
+                delays.push_back(now.time_since_epoch().count() - deadline.time_since_epoch().count());
+            });
+        }
+        std::this_thread::sleep_until(deadline + std::chrono::milliseconds(100));
+    }
+    else {
+        std::clog << "failed to make the spinner SCHED_FIFO" << std::endl;
+    }
+
+    running = false;
+    spinner.join();
+    producer.join();
+    timer_queue.stop();
+    if (!spinner_ok) {
+        return std::nullopt;
+    }
+
+    std::ofstream output(filename);
+    std::ostream_iterator<Clock::duration::rep> output_iterator(output, ",");
+    std::ranges::copy(delays, output_iterator);
+
+    return delays;
+}
+
+// NB: returns p99
+Clock::duration::rep report(const std::string& title, Delays delays) {
+    if (delays.empty()) {
+        std::clog << title << ": no samples" << std::endl;
+        return 0;
+    }
+    std::ranges::sort(delays);
+    long double sum = 0;
+    for (auto delay: delays) {
+        sum += delay;
+    }
+    auto mean = sum / delays.size();
+    auto p99 = delays[delays.size() * 99 / 100];
+    std::clog << title << ": " << delays.size() << " samples, mean=" << mean << " p99=" << p99 << " max=" << delays.back() << std::endl;
+    return p99;
+}
+
+int main() {
+    std::clog.imbue(std::locale(""));
+
+    if (!pin_to_cpu(pthread_self(), 0)) {  // NB: inherited by every thread started below
+        std::clog << "skipped: cannot pin threads to a CPU" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    auto std_delays = measure<yatq::utils::StdSync>("std_delays.dat");
+    if (!std_delays) {
+        std::clog << "skipped: SCHED_FIFO not permitted" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    auto std_p99 = report("std::mutex", std::move(*std_delays));
+
+    auto pi_delays = measure<yatq::utils::PrioInheritSync>("pi_delays.dat");
+    if (!pi_delays) {
+        std::clog << "skipped: SCHED_FIFO not permitted" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    auto pi_p99 = report("PTHREAD_PRIO_INHERIT", std::move(*pi_delays));
+
+    // NB: the inversion stalls the timer queue thread for up to 'spin_period'; priority inheritance bounds it by the
+    // producer critical section
+    std::clog << "p99 ratio std::mutex/PTHREAD_PRIO_INHERIT=" << static_cast<double>(std_p99) / std::max<Clock::duration::rep>(pi_p99, 1) << std::endl;
+    return pi_p99 < std_p99 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
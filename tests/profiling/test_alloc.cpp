@@ -0,0 +1,184 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+
+#define YATQ_DISABLE_LOGGING
+#include "yatq/move_only_function.h"
+#include "yatq/thread_pool.h"
+#include "yatq/timer_queue.h"
+
+static std::atomic<std::size_t> allocations = 0;
+
+// NB: the whole replaceable set goes through malloc/free, so every new is paired with a matching delete
+static void* allocate(std::size_t size, std::size_t alignment = 0) noexcept {
+    ++allocations;
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment == 0) {
+        return std::malloc(size);
+    }
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);  // NB: size must be a multiple
+}
+
+static void* allocate_or_throw(std::size_t size, std::size_t alignment = 0) {
+    if (void* p = allocate(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return allocate_or_throw(size); }
+void* operator new[](std::size_t size) { return allocate_or_throw(size); }
+void* operator new(std::size_t size, std::align_val_t al) { return allocate_or_throw(size, std::size_t(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return allocate_or_throw(size, std::size_t(al)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return allocate(size, std::size_t(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return allocate(size, std::size_t(al));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+// a typical capture: some ids, a deadline and a pointer to the session state (48 bytes)
+struct Capture {
+    std::array<std::uint64_t, 4> ids;
+    std::chrono::system_clock::time_point deadline;
+    void* state;
+
+    void operator()() const {}
+};
+
+template<typename Executable>
+void count(const std::string& title) {
+    using ThreadPool = yatq::ThreadPool<Executable>;
+    using TimerQueue = yatq::TimerQueue<ThreadPool>;
+
+    const auto N = 100'000;
+
+    ThreadPool thread_pool;  // NB: not started => jobs stay in the queue
+    TimerQueue timer_queue(&thread_pool);  // NB: not started => timers stay in the queue
+
+    auto deadline = std::chrono::system_clock::now() + std::chrono::hours(1);
+
+    auto before = allocations.load();
+    for (auto i = 0; i < N; ++i) {
+        timer_queue.enqueue(deadline, Capture {});
+    }
+    auto after = allocations.load();
+    long double per_call = after - before;
+    std::clog << title << " enqueue: " << N << " samples, allocations per call=" << per_call / N << std::endl;
+
+    before = allocations.load();
+    for (auto i = 0; i < N; ++i) {
+        timer_queue.enqueue(deadline, Capture {}, [capture = Capture {}](auto) {});
+    }
+    after = allocations.load();
+    per_call = after - before;
+    std::clog << title << " enqueue with callback: " << N << " samples, allocations per call=" << per_call / N << std::endl;
+
+    before = allocations.load();
+    for (auto i = 0; i < N; ++i) {
+        thread_pool.execute(Capture {});
+    }
+    after = allocations.load();
+    per_call = after - before;
+    std::clog << title << " execute: " << N << " samples, allocations per call=" << per_call / N << std::endl;
+
+    before = allocations.load();
+    for (auto i = 0; i < N; ++i) {
+        auto uid = timer_queue.enqueue(deadline, Capture {}).uid;
+        timer_queue.cancel(uid);  // NB: result slot returns to the pool
+    }
+    after = allocations.load();
+    per_call = after - before;
+    std::clog << title << " enqueue+cancel: " << N << " samples, allocations per call=" << per_call / N << std::endl;
+
+    timer_queue.clear();
+}
+
+// NB: no 'resume()' => timer queue resumes coroutines in the canceling thread
+class InlineExecutor {
+public:
+    using Executable = yatq::MoveOnlyFunction<void(void)>;
+    using Future = yatq::CompletionHandle<void>;
+
+    Future execute(Executable job) {
+        auto [slot, future] = _completions.make();
+        yatq::internal::run_and_complete<void>(job, slot);
+        return std::move(future);
+    }
+
+private:
+    yatq::CompletionPool<void> _completions;
+};
+
+struct Coroutine {
+    struct promise_type {
+        Coroutine get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+template<typename TimerQueue>
+Coroutine sleeper(TimerQueue& timer_queue, int n, typename TimerQueue::uid_t& uid) {
+    auto deadline = std::chrono::system_clock::now() + std::chrono::hours(1);
+    for (auto i = 0; i < n; ++i) {
+        auto sleep = timer_queue.sleep_until(deadline);
+        uid = sleep.uid();
+        co_await sleep;
+    }
+}
+
+void count_sleep() {
+    using TimerQueue = yatq::TimerQueue<InlineExecutor>;
+
+    const auto N = 100'000;
+
+    InlineExecutor inline_executor;
+    TimerQueue timer_queue(&inline_executor);  // NB: not started => timers stay in the queue
+
+    TimerQueue::uid_t uid;
+    sleeper(timer_queue, N + 1, uid);  // NB: coroutine frame allocated here, outside of the measurement
+
+    auto before = allocations.load();
+    for (auto i = 0; i < N; ++i) {
+        timer_queue.cancel(uid);  // NB: resumes the coroutine which sleeps again
+    }
+    auto after = allocations.load();
+    long double per_call = after - before;
+    std::clog << "co_await sleep_until+cancel: " << N << " samples, allocations per call=" << per_call / N << std::endl;
+
+    timer_queue.clear();
+}
+
+int main() {
+    count<std::function<void(void)>>("std::function");
+    count<yatq::MoveOnlyFunction<void(void)>>("yatq::MoveOnlyFunction");
+    count_sleep();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+#include <unistd.h>
+
+#define YATQ_DISABLE_LOGGING
+#include "yatq/thread_pool.h"
+#include "yatq/timer_queue.h"
+
+typedef yatq::TimerQueue<yatq::ThreadPool<>, std::chrono::system_clock> SystemTimerQueue;
+
+typedef struct {
+    std::uint64_t subscription;
+} Expiry;
+
+const std::uint32_t expiry_job = 1;
+
+// NB: resident set size, Linux only
+long resident_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    long size;
+    long resident;
+    statm >> size >> resident;
+    return resident * ::sysconf(_SC_PAGESIZE);
+}
+
+template<typename Enqueue>
+void measure(SystemTimerQueue& timer_queue, const std::string& title, std::size_t n, Enqueue&& enqueue) {
+    std::vector<SystemTimerQueue::uid_t> uids;
+    uids.reserve(n);
+    auto resident = resident_bytes();
+    auto start = SystemTimerQueue::Clock::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        uids.push_back(enqueue(i));
+    }
+    auto duration = SystemTimerQueue::Clock::now() - start;
+    long double duration_count = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    long double memory = resident_bytes() - resident;
+    std::clog << title << ": " << n << " timers, enqueue mean=" << duration_count / n << " ns, memory="
+              << memory / n << " bytes per timer" << std::endl;
+
+    start = SystemTimerQueue::Clock::now();
+    for (std::size_t i = 0; i < n; i += 100) {
+        timer_queue.cancel(uids[i]);
+    }
+    duration = SystemTimerQueue::Clock::now() - start;
+    duration_count = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    std::clog << title << ": " << n / 100 << " cancels, mean=" << duration_count / (n / 100) << " ns" << std::endl;
+}
+
+// 1M timers days ahead: kept in memory vs in the cold tier
+int main() {
+    std::clog.imbue(std::locale(""));
+
+    const std::size_t N = 1'000'000;
+    auto directory = std::filesystem::temp_directory_path() / "yatq_cold_tier";
+    std::filesystem::create_directories(directory);
+
+    yatq::ThreadPool<> thread_pool;
+    thread_pool.start(1);
+    auto now = SystemTimerQueue::Clock::now();
+    auto deadline = [now] (std::size_t i) {
+        return now + std::chrono::hours(24) + std::chrono::seconds((i * 7919) % (7 * 24 * 3600));
+    };
+
+    {
+        SystemTimerQueue timer_queue(&thread_pool);
+        timer_queue.job_registry().add<Expiry>(expiry_job, [] (const Expiry&) { return [] () {}; });
+        timer_queue.set_cold_tier(directory.string(), std::chrono::hours(1), std::chrono::hours(1));
+        timer_queue.start(SCHED_OTHER);
+        measure(timer_queue, "cold", N, [&] (std::size_t i) {
+            return timer_queue.enqueue_detached(deadline(i), yatq::make_job_descriptor(expiry_job, Expiry {i}));
+        });
+        if (timer_queue.cold_timers() != N - N / 100) {
+            std::cerr << "cold timers: " << timer_queue.cold_timers() << std::endl;
+            return EXIT_FAILURE;
+        }
+        timer_queue.stop();
+    }
+
+    {
+        SystemTimerQueue timer_queue(&thread_pool);
+        timer_queue.job_registry().add<Expiry>(expiry_job, [] (const Expiry&) { return [] () {}; });
+        timer_queue.start(SCHED_OTHER);
+        measure(timer_queue, "hot", N, [&] (std::size_t i) {
+            return timer_queue.enqueue(deadline(i), yatq::make_job_descriptor(expiry_job, Expiry {i})).uid;
+        });
+        timer_queue.stop();
+    }
+
+    thread_pool.stop();
+    std::filesystem::remove_all(directory);
+
+    return EXIT_SUCCESS;
+}
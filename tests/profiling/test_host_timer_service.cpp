@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define YATQ_DISABLE_LOGGING
+#include "yatq/host_timer_service.h"
+
+typedef yatq::HostTimerService::Clock Clock;
+
+typedef struct {
+    std::int64_t deadline;
+} Probe;
+
+const std::uint32_t probe_job = 1;
+
+// NB: runs in a child process: enqueues timers 1-2ms apart and waits for all of them to come back
+int run_client(const std::string& name, int n) {
+    yatq::HostTimerClient client(name);
+    auto deadline = Clock::now() + std::chrono::milliseconds(20);
+    for (int i = 0; i < n; ++i) {
+        deadline += std::chrono::microseconds(1'000 + (i * 7919) % 1'000);
+        client.enqueue(deadline, yatq::make_job_descriptor(probe_job, Probe {deadline.time_since_epoch().count()}));
+    }
+
+    std::vector<Clock::duration::rep> delays;
+    delays.reserve(n);
+    while (delays.size() < static_cast<std::size_t>(n)) {
+        auto count = client.wait(
+            [&delays] (const yatq::JobDescriptor& descriptor) {
+                Probe probe;
+                std::memcpy(&probe, descriptor.payload, sizeof(Probe));
+                delays.push_back(Clock::now().time_since_epoch().count() - probe.deadline);
+            },
+            std::chrono::seconds(5)
+        );
+        if (count == 0) {
+            std::cerr << "client " << ::getpid() << ": timeout with " << delays.size() << " timers of " << n << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ranges::sort(delays);
+    std::clog << "client " << ::getpid() << ": " << n << " samples, p50=" << delays[n / 2] << " p99="
+              << delays[n * 99 / 100] << " max=" << delays.back() << std::endl;
+    return (delays.front() >= 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// several processes sharing one timer service thread
+int main() {
+    std::clog.imbue(std::locale(""));
+
+    const auto processes = 8;
+    const auto N = 500;
+    const std::string name = "/yatq_test_host_timers_" + std::to_string(::getpid());
+
+    yatq::HostTimerService service(name, processes);
+    service.start(SCHED_FIFO);
+
+    std::vector<pid_t> children;
+    for (int i = 0; i < processes; ++i) {
+        auto pid = ::fork();
+        if (pid == 0) {
+            ::_exit(run_client(name, N));
+        }
+        children.push_back(pid);
+    }
+
+    auto result = EXIT_SUCCESS;
+    for (auto pid: children) {
+        int status;
+        ::waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            result = EXIT_FAILURE;
+        }
+    }
+
+    service.stop();
+    auto stats = service.stats();
+    std::clog << "service: received=" << stats.received << " delivered=" << stats.delivered << " dropped="
+              << stats.dropped << " wakeups=" << stats.wakeups << std::endl;
+    if (stats.delivered != processes * N) {
+        result = EXIT_FAILURE;
+    }
+
+    return result;
+}
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+
+#define YATQ_DISABLE_FUTURES
+#define YATQ_DISABLE_LOGGING
+#include "yatq/timer_queue.h"
+
+class InstantExecutor {
+public:
+    using Executable = std::function<void(void)>;
+
+    static void execute(const Executable& job) {
+        job();
+    }
+};
+
+typedef yatq::TimerQueue<InstantExecutor, std::chrono::system_clock> SystemTimerQueue;
+
+typedef struct {
+    std::uint64_t session;
+    std::uint32_t attempt;
+} Retry;
+
+const std::uint32_t retry_job = 1;
+
+void register_jobs(SystemTimerQueue& timer_queue) {
+    timer_queue.job_registry().add<Retry>(retry_job, [] (const Retry&) { return [] () {}; });
+}
+
+void report(const std::string& title, const SystemTimerQueue::Clock::duration& duration, std::size_t count) {
+    long double duration_count = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    std::clog << title << ": " << count << " timers, total=" << duration_count << " ns, mean=" << duration_count / count << " ns" << std::endl;
+}
+
+// restart with 1M pending timers: replaying them one by one vs restoring a snapshot
+int main() {
+    std::clog.imbue(std::locale(""));
+
+    const auto N = 1'000'000;
+    const std::string path = "timer_queue.snapshot";
+    InstantExecutor instant_executor;
+
+    auto now = SystemTimerQueue::Clock::now();
+    std::vector<std::pair<SystemTimerQueue::Clock::time_point, yatq::JobDescriptor>> timers;
+    timers.reserve(N);
+    for (auto i = 0; i < N; ++i) {
+        // NB: deadlines in arbitrary order, an hour ahead
+        auto deadline = now + std::chrono::hours(1) + std::chrono::microseconds((i * 7919L) % N);
+        timers.emplace_back(deadline, yatq::make_job_descriptor(retry_job, Retry {static_cast<std::uint64_t>(i), 1}));
+    }
+
+    {
+        SystemTimerQueue timer_queue(&instant_executor);
+        register_jobs(timer_queue);
+        timer_queue.start(SCHED_OTHER);
+
+        auto start = SystemTimerQueue::Clock::now();
+        for (auto&& [deadline, descriptor]: timers) {
+            timer_queue.enqueue_detached(deadline, descriptor);
+        }
+        report("replay", SystemTimerQueue::Clock::now() - start, N);
+
+        start = SystemTimerQueue::Clock::now();
+        auto count = timer_queue.snapshot(path);
+        report("snapshot", SystemTimerQueue::Clock::now() - start, count);
+
+        timer_queue.stop();
+    }
+
+    {
+        SystemTimerQueue timer_queue(&instant_executor);
+        register_jobs(timer_queue);
+        timer_queue.start(SCHED_OTHER);
+
+        auto start = SystemTimerQueue::Clock::now();
+        auto count = timer_queue.restore(path);
+        report("restore", SystemTimerQueue::Clock::now() - start, count);
+
+        timer_queue.stop();
+        if (count != N) {
+            std::cerr << "restored " << count << " timers of " << N << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::remove(path.c_str());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define YATQ_DISABLE_LOGGING
+#include "yatq/task.h"
+#include "yatq/thread_pool.h"
+
+typedef std::chrono::steady_clock Clock;
+typedef yatq::ThreadPool<> ThreadPool;
+
+const auto depth = 1'000'000;
+const auto round_trips = 100'000;
+const auto num_waiters = 4;
+
+void report(const std::string& title, std::size_t count, const Clock::duration& duration) {
+    long double duration_count = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    std::clog << title << ": " << count << " samples, total=" << duration_count << " ns, mean=" << duration_count / count << " ns" << std::endl;
+}
+
+bool check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::clog << "FAILED: " << what << std::endl;
+    }
+    return condition;
+}
+
+yatq::Task<long> leaf(ThreadPool& thread_pool, long i) {
+    co_await thread_pool.schedule();
+    co_return i;
+}
+
+// NB: every sub-task hops through the pool; resumed in a pool thread => stays in the worker-local ready list
+yatq::Task<long> chain(ThreadPool& thread_pool, long n) {
+    long sum = 0;
+    for (long i = 0; i < n; ++i) {
+        sum += co_await leaf(thread_pool, i);
+    }
+    co_return sum;
+}
+
+yatq::Task<void> fail(ThreadPool& thread_pool) {
+    co_await thread_pool.schedule();
+    throw std::runtime_error("task failed");
+}
+
+yatq::Task<std::string> rethrow(ThreadPool& thread_pool) {
+    try {
+        co_await fail(thread_pool);
+    }
+    catch (const std::runtime_error& exc) {
+        co_return exc.what();
+    }
+    co_return "";
+}
+
+yatq::Task<int> hop(ThreadPool& thread_pool) {
+    co_await thread_pool.schedule();
+    co_return 1;
+}
+
+int main() {
+    std::clog.imbue(std::locale(""));
+
+    bool ok = true;
+    ThreadPool thread_pool;
+    thread_pool.start(1);
+
+    auto start = Clock::now();
+    auto sum = yatq::sync_wait(chain(thread_pool, depth));
+    report("co_await chain", depth, Clock::now() - start);
+    ok &= check(sum == static_cast<long>(depth) * (depth - 1) / 2, "co_await chain result");
+
+    ok &= check(yatq::sync_wait(rethrow(thread_pool)) == "task failed", "exception caught by the awaiting task");
+    try {
+        yatq::sync_wait(fail(thread_pool));
+        ok &= check(false, "exception rethrown by sync_wait()");
+    }
+    catch (const std::runtime_error&) {}
+
+    // NB: the task completes in a pool thread while the waiter destroys the frame => exercises the hand-over
+    std::atomic<int> total = 0;
+    std::vector<std::thread> waiters;
+    start = Clock::now();
+    for (auto i = 0; i < num_waiters; ++i) {
+        waiters.emplace_back([&thread_pool, &total] () {
+            for (auto j = 0; j < round_trips / num_waiters; ++j) {
+                total.fetch_add(yatq::sync_wait(hop(thread_pool)), std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto&& waiter: waiters) {
+        waiter.join();
+    }
+    report("sync_wait round trip", round_trips, Clock::now() - start);
+    ok &= check(total == round_trips / num_waiters * num_waiters, "sync_wait round trips");
+
+    thread_pool.stop();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
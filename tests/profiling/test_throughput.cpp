@@ -0,0 +1,127 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define YATQ_DISABLE_LOGGING
+#include "yatq/keyed_thread_pool.h"
+#include "yatq/thread_pool.h"
+#include "yatq/work_stealing_thread_pool.h"
+
+typedef std::chrono::steady_clock Clock;
+
+const auto N = 1'000'000;
+const auto num_producers = 4;
+const auto fan_out = 16;
+
+void wait_for(const std::atomic<int>& counter, int value) {
+    while (counter.load(std::memory_order_acquire) < value) {
+        std::this_thread::yield();
+    }
+}
+
+void report(const std::string& title, std::size_t num_threads, const Clock::duration& duration) {
+    auto seconds = std::chrono::duration<long double>(duration).count();
+    std::clog << title << ": " << num_threads << " threads, " << N << " jobs, jobs per second=" << N / seconds << std::endl;
+}
+
+// external producers submitting trivial jobs: contention on submission and pickup
+template<typename ThreadPool>
+void measure_external(const std::string& title, std::size_t num_threads, const std::function<void(ThreadPool&)>& configure = {}) {
+    ThreadPool thread_pool;
+    if (configure) {
+        configure(thread_pool);
+    }
+    thread_pool.start(num_threads);
+
+    std::atomic<int> counter = 0;
+    auto start = Clock::now();
+    std::vector<std::thread> producers;
+    for (auto i = 0; i < num_producers; ++i) {
+        producers.emplace_back([&thread_pool, &counter] () {
+            for (auto j = 0; j < N / num_producers; ++j) {
+                thread_pool.execute_detached([&counter] () { counter.fetch_add(1, std::memory_order_release); });
+            }
+        });
+    }
+    for (auto&& producer: producers) {
+        producer.join();
+    }
+    wait_for(counter, N);
+    auto stop = Clock::now();
+
+    thread_pool.stop();
+    report(title + " external", num_threads, stop - start);
+}
+
+// external producers submitting trivial jobs, each with its own key: no contention on pickup
+template<typename ThreadPool>
+void measure_keyed(const std::string& title, std::size_t num_threads) {
+    ThreadPool thread_pool;
+    thread_pool.start(num_threads);
+
+    std::atomic<int> counter = 0;
+    auto start = Clock::now();
+    std::vector<std::thread> producers;
+    for (auto i = 0; i < num_producers; ++i) {
+        producers.emplace_back([&thread_pool, &counter, i] () {
+            for (auto j = 0; j < N / num_producers; ++j) {
+                thread_pool.execute_detached(i, [&counter] () { counter.fetch_add(1, std::memory_order_release); });
+            }
+        });
+    }
+    for (auto&& producer: producers) {
+        producer.join();
+    }
+    wait_for(counter, N);
+    auto stop = Clock::now();
+
+    thread_pool.stop();
+    report(title + " keyed", num_threads, stop - start);
+}
+
+// jobs submitting jobs: per-thread queues keep the children local
+template<typename ThreadPool>
+void measure_fan_out(const std::string& title, std::size_t num_threads) {
+    ThreadPool thread_pool;
+    thread_pool.start(num_threads);
+
+    std::atomic<int> counter = 0;
+    auto start = Clock::now();
+    for (auto i = 0; i < N / fan_out; ++i) {
+        thread_pool.execute_detached([&thread_pool, &counter] () {
+            for (auto j = 0; j < fan_out; ++j) {
+                thread_pool.execute_detached([&counter] () { counter.fetch_add(1, std::memory_order_release); });
+            }
+        });
+    }
+    wait_for(counter, N / fan_out * fan_out);
+    auto stop = Clock::now();
+
+    thread_pool.stop();
+    report(title + " fan-out", num_threads, stop - start);
+}
+
+int main() {
+    std::clog.imbue(std::locale(""));
+
+    using RingThreadPool = yatq::ThreadPool<yatq::MoveOnlyFunction<void(void)>, yatq::utils::StdSync, yatq::utils::RingQueue<>>;
+
+    for (std::size_t num_threads: {1, 8, 32}) {
+        measure_external<yatq::ThreadPool<>>("ThreadPool", num_threads);
+        measure_external<yatq::ThreadPool<>>("ThreadPool (stats)", num_threads, [] (auto& thread_pool) { thread_pool.set_stats_enabled(true); });
+        measure_external<RingThreadPool>("ThreadPool (RingQueue)", num_threads);
+        measure_external<yatq::WorkStealingThreadPool<>>("WorkStealingThreadPool", num_threads);
+        measure_external<yatq::KeyedThreadPool<>>("KeyedThreadPool", num_threads);
+        measure_keyed<yatq::KeyedThreadPool<>>("KeyedThreadPool", num_threads);
+        measure_fan_out<yatq::ThreadPool<>>("ThreadPool", num_threads);
+        measure_fan_out<RingThreadPool>("ThreadPool (RingQueue)", num_threads);
+        measure_fan_out<yatq::WorkStealingThreadPool<>>("WorkStealingThreadPool", num_threads);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,7 +1,10 @@
 import pytest
 
+import os
 import time
 
+from pytq import ThreadPool, overflow_policy_t, utils
+
 
 def test_smoke(thread_pool):
     x = 2
@@ -23,3 +26,72 @@ def test_exception(thread_pool):
     future = thread_pool.execute(job=f)
     with pytest.raises(Exception):
         future.get()
+
+
+def test_execute_detached(thread_pool):
+    x = 2
+
+    def f():
+        nonlocal x
+        x += 1
+
+    assert thread_pool.execute_detached(job=f) is None
+
+    time.sleep(0.1)
+    assert x == 3
+
+
+def test_start_groups():
+    thread_pool = ThreadPool()
+    thread_pool.start(groups=[utils.ThreadGroup(num_threads=2, cpus=[0])])
+
+    future = thread_pool.execute(job=lambda: os.sched_getaffinity(0))
+    assert future.get() == {0}
+
+    thread_pool.stop()
+
+
+def test_try_execute():
+    thread_pool = ThreadPool()
+    thread_pool.set_capacity(capacity=1)
+    thread_pool.set_overflow_policy(policy=overflow_policy_t.reject_when_full)
+    thread_pool.start(1)
+
+    blocker = thread_pool.execute(job=lambda: time.sleep(0.2))
+    time.sleep(0.1)
+    queued = thread_pool.try_execute(job=lambda: 1)
+    assert queued is not None
+    assert thread_pool.try_execute(job=lambda: 2) is None
+    assert queued.get() == 1
+    assert thread_pool.overflow_stats().rejected == 1
+
+    blocker.get()
+    thread_pool.stop()
+
+
+def test_stats():
+    thread_pool = ThreadPool()
+    thread_pool.set_stats_enabled(enabled=True)
+    thread_pool.start(1)
+
+    blocker = thread_pool.execute(job=lambda: time.sleep(0.2))
+    time.sleep(0.05)
+    queued = [thread_pool.execute(job=lambda: None) for _ in range(3)]
+    time.sleep(0.05)
+    stats = thread_pool.stats()
+    assert stats.queue_depth == 3
+    assert stats.oldest_job_age >= 50_000_000
+
+    blocker.get()
+    for future in queued:
+        future.get()
+    time.sleep(0.05)
+    stats = thread_pool.stats()
+    assert (stats.queue_depth, stats.oldest_job_age) == (0, 0)
+    assert (stats.wait_time.count, stats.service_time.count) == (4, 4)
+    assert stats.service_time.max >= 200_000_000
+    assert len(stats.workers) == 1
+    assert stats.workers[0].jobs == 4
+    assert stats.workers[0].busy_time >= 200_000_000
+
+    thread_pool.stop()
@@ -4,6 +4,8 @@ from datetime import datetime, timedelta
 from functools import partial
 import time
 
+from pytq import TimerQueue, admission_policy_t
+
 
 def test_smoke(timer_queue):
     x = 2
@@ -254,3 +256,91 @@ def test_exception(timer_queue):
     handle = timer_queue.enqueue(deadline=deadline, job=f)
     with pytest.raises(Exception):
         handle.result.get()
+
+
+def test_enqueue_detached(timer_queue):
+    x = 2
+
+    def f():
+        nonlocal x
+        x += 1
+
+    now = datetime.now()
+    deadline = now + timedelta(milliseconds=100)
+    uid = timer_queue.enqueue_detached(deadline=deadline, job=f)
+    assert timer_queue.in_queue(uid=uid)
+
+    time.sleep(0.2)
+    assert x == 3
+    assert not timer_queue.in_queue(uid=uid)
+
+
+def test_on_complete(timer_queue):
+    results = []
+
+    def on_complete(future):
+        results.append(future.get())
+
+    now = datetime.now()
+    deadline = now + timedelta(milliseconds=100)
+    timer_queue.enqueue(deadline=deadline, job=lambda: 42, on_complete=on_complete)
+
+    time.sleep(0.2)
+    assert results == [42]
+
+
+def test_on_complete_exception(timer_queue):
+    errors = []
+
+    def f():
+        raise RuntimeError
+
+    def on_complete(future):
+        try:
+            future.get()
+        except Exception as exc:
+            errors.append(exc)
+
+    now = datetime.now()
+    deadline = now + timedelta(milliseconds=100)
+    timer_queue.enqueue(deadline=deadline, job=f, on_complete=on_complete)
+
+    time.sleep(0.2)
+    assert len(errors) == 1
+
+
+def test_capacity(thread_pool):
+    timer_queue = TimerQueue(executor=thread_pool)
+    timer_queue.set_capacity(capacity=1, policy=admission_policy_t.evict_when_full)
+    timer_queue.start()
+
+    now = datetime.now()
+    deadline = now + timedelta(milliseconds=100)
+    low = timer_queue.enqueue(deadline=deadline, job=lambda: 1, priority=-1)
+    high = timer_queue.enqueue(deadline=deadline, job=lambda: 2)
+    with pytest.raises(Exception):
+        timer_queue.enqueue(deadline=deadline, job=lambda: 3, priority=-1)
+
+    assert high.result.get() == 2
+    with pytest.raises(Exception):
+        low.result.get()
+    stats = timer_queue.shed_stats()
+    assert (stats.rejected, stats.evicted) == (1, 1)
+
+    timer_queue.stop()
+
+
+def test_stats(timer_queue):
+    now = datetime.now()
+    deadline = now + timedelta(milliseconds=100)
+    handles = [timer_queue.enqueue(deadline=deadline, job=lambda: None) for _ in range(10)]
+    assert timer_queue.cancel(handles[0].uid)
+
+    stats = timer_queue.stats()
+    assert (stats.enqueued, stats.canceled, stats.live_timers) == (10, 1, 9)
+
+    time.sleep(0.3)
+    stats = timer_queue.stats()
+    assert (stats.fired, stats.live_timers, stats.heap_size) == (9, 0, 0)
+    assert stats.lateness.count == 9
+    assert stats.lateness.p50 <= stats.lateness.max